@@ -0,0 +1,222 @@
+// Benchmarks every int2048 operator across operand sizes and prints one
+// JSON object per measurement on standard output:
+//
+//   {"op":"mul","shape":"balanced","signs":"-+","digits_a":1000,
+//    "digits_b":1000,"iterations":4096,"ns_per_op":61234.5,
+//    "digits_per_sec":3.26e+07}
+//
+//   bench [--max-digits N] [--min-time S] [--budget S] [--ops a,b,...]
+//
+// Sizes run from 10 digits up to --max-digits (default 10^6) in powers of
+// ten. Each case repeats its operation until --min-time seconds (default
+// 0.1) have passed. A series stops growing once the next size is expected
+// to take longer than --budget seconds (default 5) per operation, judging
+// by the previous size and the operation's complexity; such cases print
+// "skipped":true instead.
+//
+// Operations: read, print (operator<<), add, minus, mul, div, mod, less
+// and equal. "balanced" operands have the same length, "unbalanced" ones
+// differ tenfold; for div and mod the shapes describe the quotient and
+// divisor instead, so a balanced division splits the dividend in half.
+// "signs" gives the signs of the two operands. add and minus include
+// copying the left operand into a reused result, as the API requires.
+#include "src/include/int2048.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sjtu;
+
+// Results are stored here so that no operation is optimized away
+volatile size_t bench_sink;
+
+struct bench_case {
+    int2048 a, b, r;
+    std::string text;  // decimal form of a, for read
+    std::ostringstream out;
+    size_t sink = 0;
+};
+
+struct bench_op {
+    const char* name;
+    void (*run)(bench_case&);
+    bool binary;
+    bool division;
+    double growth;  // expected time ratio for ten times the digits
+};
+
+static void run_read(bench_case& c) {
+    c.r.read(c.text);
+}
+
+static void run_print(bench_case& c) {
+    c.out.str(std::string());
+    c.out << c.a;
+    c.sink += c.out.tellp();
+}
+
+static void run_add(bench_case& c) {
+    c.r = c.a;
+    c.r.add(c.b);
+}
+
+static void run_minus(bench_case& c) {
+    c.r = c.a;
+    c.r.minus(c.b);
+}
+
+static void run_mul(bench_case& c) {
+    c.r = c.a * c.b;
+}
+
+static void run_div(bench_case& c) {
+    c.r = c.a / c.b;
+}
+
+static void run_mod(bench_case& c) {
+    c.r = c.a % c.b;
+}
+
+static void run_less(bench_case& c) {
+    c.sink += c.a < c.b;
+}
+
+static void run_equal(bench_case& c) {
+    c.sink += c.a == c.b;
+}
+
+static const bench_op OPS[] = {
+    {"read", run_read, false, false, 10},   {"print", run_print, false, false, 10},
+    {"add", run_add, true, false, 10},      {"minus", run_minus, true, false, 10},
+    {"mul", run_mul, true, false, 40},      {"div", run_div, true, true, 100},
+    {"mod", run_mod, true, true, 100},      {"less", run_less, true, false, 10},
+    {"equal", run_equal, true, false, 10},
+};
+
+static std::string random_digits(std::mt19937_64& rng, size_t n, bool negative) {
+    std::string s = negative ? "-" : "";
+    s += char('1' + rng() % 9);
+    for (size_t i = 1; i < n; ++i) {
+        s += char('0' + rng() % 10);
+    }
+    return s;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prints one measurement and returns the time per operation in seconds
+static double measure(const bench_op& op, const char* shape, const char* signs, size_t digits_a,
+                      size_t digits_b, double min_time, std::mt19937_64& rng) {
+    bench_case c;
+    c.text = random_digits(rng, digits_a, signs[0] == '-');
+    c.a.read(c.text);
+    std::string b_text = random_digits(rng, digits_b, false);
+    if (op.division) {
+        // Dividend digits_a + digits_b long, quotient digits_a long
+        c.a *= int2048(b_text);
+        c.a += int2048(b_text.substr(0, b_text.size() - 1) + "0");
+    } else if (digits_a == digits_b) {
+        // Equal magnitude up to the last digit, so comparisons scan it all
+        b_text = c.text.substr(c.text[0] == '-');
+        b_text.back() = b_text.back() == '9' ? '8' : char(b_text.back() + 1);
+    }
+    c.b.read(signs[1] == '-' ? "-" + b_text : b_text);
+    c.r.reserve(2 * (digits_a + digits_b) + 9);
+
+    size_t iterations = 0;
+    double elapsed = 0;
+    for (size_t batch = 1;; batch *= 2) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < batch; ++i) {
+            op.run(c);
+        }
+        elapsed += seconds_since(start);
+        iterations += batch;
+        if (elapsed >= min_time) break;
+    }
+
+    double per_op = elapsed / iterations;
+    size_t total_digits = op.binary ? digits_a + digits_b : digits_a;
+    if (op.division) total_digits += digits_b;
+    std::printf("{\"op\":\"%s\",\"shape\":\"%s\",\"signs\":\"%s\",\"digits_a\":%zu,"
+                "\"digits_b\":%zu,\"iterations\":%zu,\"ns_per_op\":%.1f,"
+                "\"digits_per_sec\":%.4g}\n",
+                op.name, shape, signs, op.division ? digits_a + digits_b : digits_a,
+                op.binary ? digits_b : 0, iterations, per_op * 1e9, total_digits / per_op);
+    std::fflush(stdout);
+
+    bench_sink = c.sink + c.r.memory_usage();
+    return per_op;
+}
+
+static void print_skipped(const bench_op& op, const char* shape, const char* signs,
+                          size_t digits_a, size_t digits_b) {
+    std::printf("{\"op\":\"%s\",\"shape\":\"%s\",\"signs\":\"%s\",\"digits_a\":%zu,"
+                "\"digits_b\":%zu,\"skipped\":true}\n",
+                op.name, shape, signs, op.division ? digits_a + digits_b : digits_a,
+                op.binary ? digits_b : 0);
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_digits = 1000000;
+    double min_time = 0.1;
+    double budget = 5;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-digits" && i + 1 < argc) {
+            max_digits = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else if (arg == "--budget" && i + 1 < argc) {
+            budget = std::atof(argv[++i]);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            filter = "," + std::string(argv[++i]) + ",";
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--max-digits N] [--min-time S] [--budget S] [--ops a,b,...]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    static const char* const SHAPES[] = {"balanced", "unbalanced"};
+    static const char* const SIGNS[] = {"++", "-+", "+-", "--"};
+    static const char* const UNARY_SIGNS[] = {"+", "-"};
+
+    std::mt19937_64 rng(2048);
+    for (const bench_op& op : OPS) {
+        if (!filter.empty() && filter.find("," + std::string(op.name) + ",") == std::string::npos) {
+            continue;
+        }
+        for (int shape = 0; shape < (op.binary ? 2 : 1); ++shape) {
+            for (int signs = 0; signs < (op.binary ? 4 : 2); ++signs) {
+                double previous = 0;
+                for (size_t n = 10; n <= max_digits; n *= 10) {
+                    size_t digits_a = op.division ? n / 2 : n;
+                    size_t digits_b = op.division ? n / 2 : n;
+                    if (shape == 1) {
+                        // Long left operand, or for division a long quotient
+                        digits_a = op.division ? n - n / 11 : n;
+                        digits_b = op.division ? std::max<size_t>(1, n / 11) : n / 10;
+                    }
+                    const char* sign_text = op.binary ? SIGNS[signs] : UNARY_SIGNS[signs];
+                    if (previous * op.growth > budget) {
+                        print_skipped(op, SHAPES[shape], sign_text, digits_a, digits_b);
+                        continue;
+                    }
+                    previous = measure(op, SHAPES[shape], sign_text, digits_a, digits_b,
+                                       min_time, rng);
+                }
+            }
+        }
+    }
+    return 0;
+}
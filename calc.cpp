@@ -0,0 +1,41 @@
+// Runs a register-machine program (see src/include/register_machine.h).
+//
+//   calc [file]
+//
+// The program is read from file, or from standard input when no file is
+// given. Errors are reported on standard error with exit status 1.
+#include "src/include/register_machine.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using namespace sjtu;
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [file]\n";
+        return 2;
+    }
+
+    std::ifstream file;
+    if (argc == 2) {
+        file.open(argv[1], std::ios::binary);
+        if (!file) {
+            std::cerr << "cannot open " << argv[1] << '\n';
+            return 2;
+        }
+    }
+    std::istream& in = argc == 2 ? static_cast<std::istream&>(file) : std::cin;
+    std::string program((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    register_machine machine;
+    try {
+        machine.run(program, std::cout);
+    } catch (const std::exception& e) {
+        std::cout.flush();
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
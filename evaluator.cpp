@@ -0,0 +1,236 @@
+// Batch evaluator: reads lines of the form "a op b" and prints one result
+// per line, in input order.
+//
+//   evaluator [-j threads] [file]
+//
+// op is one of + - * / % << >> & | ^ == != < > <= >=; comparisons print 1
+// or 0. Lines that cannot be evaluated print "error" and make the exit
+// status 1, as do left shifts by more than INT_MAX bits. Blank lines are
+// skipped. -j 0 uses one thread per hardware thread; at most 256 threads
+// are used.
+#include "src/include/int2048.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sjtu;
+
+// Lines handed to the workers at a time
+static const size_t BATCH_LINES = 1 << 14;
+// Larger -j values are clamped to this
+static const long MAX_THREADS = 256;
+// Largest left shift evaluated; beyond it the result alone would need
+// hundreds of MiB, so the line is an error instead of a failed allocation
+static const long long MAX_SHIFT_BITS = INT_MAX;
+
+// Per-thread state reused from line to line
+struct worker_state {
+    int2048 lhs, rhs, result;
+    std::string token;
+    std::ostringstream out;
+    bool failed = false;
+};
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool next_token(const char*& p, const char* end, std::string& token) {
+    while (p < end && is_blank(*p)) ++p;
+    const char* start = p;
+    while (p < end && !is_blank(*p)) ++p;
+    token.assign(start, p);
+    return p > start;
+}
+
+static bool is_number(const std::string& s) {
+    size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+    if (i == s.size()) return false;
+    for (; i < s.size(); ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+    }
+    return true;
+}
+
+static void evaluate_line(const char* p, const char* end, worker_state& state) {
+    std::string op;
+    if (!next_token(p, end, state.token) || !is_number(state.token)) {
+        state.out << "error\n";
+        state.failed = true;
+        return;
+    }
+    state.lhs.read(state.token);
+    if (!next_token(p, end, op) || !next_token(p, end, state.token) ||
+        !is_number(state.token) || p != end) {
+        state.out << "error\n";
+        state.failed = true;
+        return;
+    }
+    // Shift counts must fit a long long, and a left shift must leave a
+    // result that can be allocated
+    long long shift = 0;
+    if (op == "<<" || op == ">>") {
+        if (state.token.size() <= 18) shift = std::atoll(state.token.c_str());
+        if (state.token.size() > 18 || (op == "<<" ? shift : -shift) > MAX_SHIFT_BITS) {
+            state.out << "error\n";
+            state.failed = true;
+            return;
+        }
+    }
+    state.rhs.read(state.token);
+
+    try {
+        int2048& r = state.result;
+        if (op == "+") {
+            r = state.lhs;
+            r += state.rhs;
+        } else if (op == "-") {
+            r = state.lhs;
+            r -= state.rhs;
+        } else if (op == "*") {
+            r = state.lhs;
+            r *= state.rhs;
+        } else if (op == "/") {
+            r = state.lhs / state.rhs;
+        } else if (op == "%") {
+            r = state.lhs % state.rhs;
+        } else if (op == "<<") {
+            r = state.lhs;
+            r <<= shift;
+        } else if (op == ">>") {
+            r = state.lhs;
+            r >>= shift;
+        } else if (op == "&") {
+            r = state.lhs;
+            r &= state.rhs;
+        } else if (op == "|") {
+            r = state.lhs;
+            r |= state.rhs;
+        } else if (op == "^") {
+            r = state.lhs;
+            r ^= state.rhs;
+        } else if (op == "==") {
+            r = int2048(state.lhs == state.rhs);
+        } else if (op == "!=") {
+            r = int2048(state.lhs != state.rhs);
+        } else if (op == "<") {
+            r = int2048(state.lhs < state.rhs);
+        } else if (op == ">") {
+            r = int2048(state.lhs > state.rhs);
+        } else if (op == "<=") {
+            r = int2048(state.lhs <= state.rhs);
+        } else if (op == ">=") {
+            r = int2048(state.lhs >= state.rhs);
+        } else {
+            state.out << "error\n";
+            state.failed = true;
+            return;
+        }
+        state.out << r << '\n';
+    } catch (const std::exception&) {
+        state.out << "error\n";
+        state.failed = true;
+    }
+}
+
+// Evaluates lines [first, last) into state.out
+static void evaluate_lines(const std::vector<std::pair<const char*, const char*>>& lines,
+                           size_t first, size_t last, worker_state& state) {
+    for (size_t i = first; i < last; ++i) {
+        evaluate_line(lines[i].first, lines[i].second, state);
+    }
+}
+
+static int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [-j threads] [file]\n", program);
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned threads = 1;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            char* end;
+            long count = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end || count < 0) return usage(argv[0]);
+            // 0 picks the hardware concurrency
+            threads = count ? (unsigned)std::min(count, MAX_THREADS)
+                            : std::max(1u, std::thread::hardware_concurrency());
+        } else if (!path && arg[0] != '-') {
+            path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    FILE* in = path ? std::fopen(path, "rb") : stdin;
+    if (!in) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    std::vector<worker_state> states(threads);
+    std::vector<std::pair<const char*, const char*>> lines;
+    std::string pending;  // input not yet split into complete lines
+    std::vector<char> chunk(1 << 20);
+    bool failed = false;
+    bool eof = false;
+
+    while (!eof) {
+        size_t got = std::fread(chunk.data(), 1, chunk.size(), in);
+        eof = got < chunk.size();
+        pending.append(chunk.data(), got);
+
+        // Split off every complete line (all of them at end of input)
+        size_t consumed = 0;
+        lines.clear();
+        for (size_t pos = 0; pos < pending.size();) {
+            size_t newline = pending.find('\n', pos);
+            if (newline == std::string::npos) {
+                if (!eof) break;
+                newline = pending.size();
+            }
+            const char* begin = pending.data() + pos;
+            const char* end = pending.data() + newline;
+            while (begin < end && is_blank(*begin)) ++begin;
+            while (end > begin && is_blank(end[-1])) --end;
+            if (begin < end) lines.emplace_back(begin, end);
+            pos = consumed = newline + 1;
+        }
+
+        // Each batch is split into one contiguous slice per thread and the
+        // slices are written out in order
+        for (size_t first = 0; first < lines.size(); first += BATCH_LINES) {
+            size_t last = std::min(lines.size(), first + BATCH_LINES);
+            size_t step = (last - first + threads - 1) / threads;
+            std::vector<std::thread> workers;
+            for (unsigned t = 1; t < threads && first + t * step < last; ++t) {
+                workers.emplace_back(evaluate_lines, std::cref(lines), first + t * step,
+                                     std::min(last, first + (t + 1) * step), std::ref(states[t]));
+            }
+            evaluate_lines(lines, first, std::min(last, first + step), states[0]);
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            for (worker_state& state : states) {
+                const std::string text = state.out.str();
+                std::fwrite(text.data(), 1, text.size(), stdout);
+                state.out.str(std::string());
+                failed |= state.failed;
+            }
+        }
+        pending.erase(0, std::min(consumed, pending.size()));
+    }
+
+    if (path) std::fclose(in);
+    std::fflush(stdout);
+    return failed ? 1 : 0;
+}
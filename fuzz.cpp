@@ -0,0 +1,230 @@
+// Differential fuzzing and stress for int2048.
+//
+//   fuzz [--seed N] [--rounds N] [--max-digits N] [--budget-scale X]
+//
+// Every round draws random operands of a random size class and sign and
+// checks algebraic identities ((a/b)*b + a%b == a, (a*b)/b == a, the floor
+// rounding of / and %, distributivity, shift round trips, ...). Each
+// algorithm tier is cross-checked against the schoolbook reference by
+// moving the runtime crossovers (see algorithm_thresholds), and every
+// operation must finish within the time budget of its size class, scaled
+// by --budget-scale. The first failure prints the operands and exits 1.
+//
+// Operands favour the shapes that break carry and borrow loops: runs of
+// nines and zeros, values next to powers of the base, and sizes around
+// the crossovers.
+#include "src/include/int2048.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace sjtu;
+
+struct size_class {
+    size_t max_digits;
+    double budget_ms;  // per operation
+};
+
+static const size_class SIZE_CLASSES[] = {
+    {20, 1}, {200, 2}, {2000, 20}, {20000, 1000}, {200000, 20000},
+};
+
+static std::mt19937_64 rng;
+static double budget_scale = 1;
+static size_t rounds_done = 0;
+
+static std::string to_string(const int2048& x) {
+    std::ostringstream out;
+    out << x;
+    return out.str();
+}
+
+// A number of exactly n digits, n >= 1
+static std::string random_digits(size_t n) {
+    std::string s(n, '0');
+    switch (rng() % 5) {
+    case 0:  // nines, with a few other digits
+        for (char& c : s) c = rng() % 8 ? '9' : char('0' + rng() % 10);
+        break;
+    case 1:  // a leading one followed mostly by zeros
+        for (char& c : s) c = rng() % 8 ? '0' : char('0' + rng() % 10);
+        break;
+    case 2:  // 10^9k - 1 or 10^9k + small
+        for (char& c : s) c = rng() % 2 ? '9' : '0';
+        for (size_t i = 0; i < n; ++i) s[i] = (n - i) % 9 == 0 ? '1' : s[i];
+        break;
+    default:
+        for (char& c : s) c = char('0' + rng() % 10);
+    }
+    if (s[0] == '0') s[0] = char('1' + rng() % 9);
+    return s;
+}
+
+static int2048 random_value(size_t max_digits) {
+    if (rng() % 32 == 0) return int2048(0);
+    if (rng() % 32 == 0) return int2048((long long)(rng() % 7) - 3);
+    size_t n = 1 + rng() % max_digits;
+    std::string s = random_digits(n);
+    return int2048(rng() % 2 ? "-" + s : s);
+}
+
+[[noreturn]] static void fail(const char* check, const int2048& a, const int2048& b,
+                              const std::string& detail = "") {
+    std::cerr << "FAILED after " << rounds_done << " rounds: " << check << "\n";
+    if (!detail.empty()) std::cerr << detail << "\n";
+    std::cerr << "a = " << a << "\nb = " << b << "\n";
+    std::exit(1);
+}
+
+#define CHECK(cond, a, b)                  \
+    do {                                   \
+        if (!(cond)) fail(#cond, (a), (b)); \
+    } while (0)
+
+// Runs op and fails if it takes longer than the class budget
+template <class F> static void timed(const char* name, const size_class& cls, const int2048& a,
+                                     const int2048& b, F op) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    op();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                    .count();
+    if (ms > cls.budget_ms * budget_scale) {
+        char detail[128];
+        std::snprintf(detail, sizeof(detail), "%s took %.1f ms, budget %.1f ms", name, ms,
+                      cls.budget_ms * budget_scale);
+        fail("time budget", a, b, detail);
+    }
+}
+
+static void check_tiers(const int2048& a, const int2048& b, const int2048& product) {
+    const algorithm_thresholds defaults = get_algorithm_thresholds();
+    algorithm_thresholds t = defaults;
+
+    // Schoolbook reference for products and fused multiply-add
+    t.karatsuba = (size_t)-1;
+    set_algorithm_thresholds(t);
+    int2048 reference = a * b;
+    int2048 acc = a;
+    acc.addmul(a, b);
+    int2048 expected_acc = a + reference;
+    set_algorithm_thresholds(defaults);
+    CHECK(product == reference, a, b);
+    CHECK(acc == expected_acc, a, b);
+
+    // Karatsuba down to its smallest operands
+    t.karatsuba = 4;
+    set_algorithm_thresholds(t);
+    int2048 deep = a * b;
+    int2048 deep_acc = a;
+    deep_acc.addmul(a, b);
+    set_algorithm_thresholds(defaults);
+    CHECK(deep == reference, a, b);
+    CHECK(deep_acc == expected_acc, a, b);
+
+    // Decimal and binary shift kernels
+    long long k = rng() % 2000;
+    t.decimal_shift_percent = 0;
+    set_algorithm_thresholds(t);
+    int2048 binary_left = a << k, binary_right = a >> k;
+    t.decimal_shift_percent = (size_t)-1 / 1024;
+    set_algorithm_thresholds(t);
+    int2048 decimal_left = a << k, decimal_right = a >> k;
+    set_algorithm_thresholds(defaults);
+    CHECK(binary_left == decimal_left, a, b);
+    CHECK(binary_right == decimal_right, a, b);
+}
+
+static void round(const size_class& cls) {
+    int2048 a = random_value(cls.max_digits);
+    int2048 b = random_value(cls.max_digits);
+    if (rng() % 4 == 0) b = random_value(std::max<size_t>(1, cls.max_digits / 10));
+    int2048 c = random_value(cls.max_digits / 4 + 1);
+    int2048 zero(0);
+
+    int2048 sum, difference, product, quotient, remainder;
+    timed("add", cls, a, b, [&] { sum = a + b; });
+    timed("minus", cls, a, b, [&] { difference = a - b; });
+    timed("multiply", cls, a, b, [&] { product = a * b; });
+
+    // Text round trip and comparison consistency
+    CHECK(int2048(to_string(a)) == a, a, b);
+    CHECK((a < b) + (a == b) + (a > b) == 1, a, b);
+    CHECK((a <= b) == !(a > b) && (a >= b) == !(a < b) && (a != b) == !(a == b), a, b);
+    CHECK((a < b) == (difference < zero), a, b);
+
+    // Ring identities
+    CHECK(sum - b == a, a, b);
+    CHECK(difference + b == a, a, b);
+    CHECK(b - a == -difference, a, b);
+    CHECK(a - a == zero && to_string(a - a) == "0", a, b);
+    CHECK(b * a == product, a, b);
+    CHECK((a + b) * c == a * c + b * c, a, b);
+
+    // Floor division
+    if (b != zero) {
+        timed("divide", cls, a, b, [&] { quotient = a / b; });
+        timed("modulo", cls, a, b, [&] { remainder = a % b; });
+        CHECK(quotient * b + remainder == a, a, b);
+        bool remainder_ok = b > zero ? zero <= remainder && remainder < b
+                                     : b < remainder && remainder <= zero;
+        CHECK(remainder_ok, a, b);
+        CHECK(to_string(remainder) != "-0" && to_string(quotient) != "-0", a, b);
+        int2048 back;
+        timed("divide", cls, a, b, [&] { back = product / b; });
+        CHECK(back == a, a, b);
+        CHECK(product % b == zero, a, b);
+    }
+
+    // Shifts: left is multiplication by 2^k, right is floor division
+    long long k = rng() % 200;
+    int2048 power = int2048(1) << k;
+    CHECK((a << k) == a * power, a, b);
+    CHECK((a >> k) == a / power, a, b);
+    CHECK(((a << k) >> k) == a, a, b);
+
+    check_tiers(a, b, product);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long long seed = std::random_device()();
+    size_t rounds = 2000;
+    size_t max_digits = 20000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            rounds = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-digits" && i + 1 < argc) {
+            max_digits = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--budget-scale" && i + 1 < argc) {
+            budget_scale = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--seed N] [--rounds N] [--max-digits N] [--budget-scale X]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+    std::cout << "seed " << seed << std::endl;
+    rng.seed(seed);
+
+    // Small classes get most of the rounds, since they cover the edge cases
+    size_t classes = 0;
+    while (classes < sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]) &&
+           SIZE_CLASSES[classes].max_digits <= max_digits) {
+        ++classes;
+    }
+    if (classes == 0) classes = 1;
+    for (; rounds_done < rounds; ++rounds_done) {
+        size_t pick = rng() % 16;
+        size_t index = pick < 8 ? 0 : pick < 12 ? 1 : pick < 14 ? 2 : 3 + pick % 2;
+        round(SIZE_CLASSES[std::min(index, classes - 1)]);
+    }
+    std::cout << rounds << " rounds passed" << std::endl;
+    return 0;
+}
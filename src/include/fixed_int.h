@@ -0,0 +1,284 @@
+#pragma once
+#ifndef SJTU_FIXED_INT
+#define SJTU_FIXED_INT
+
+// Signed integers of a fixed capacity, for values with a known bound.
+//
+//   typedef sjtu::fixed_int<sjtu::limbs_for_bits(2048)> int2048_bits;
+//
+// fixed_int<Limbs> holds |x| < 10^(9 * Limbs) in Limbs base-10^9 limbs
+// inside the object, the same sign-magnitude layout as int2048, so
+// converting between the two copies limbs without any base conversion.
+// Nothing allocates, the kernels loop over compile-time bounds, and
+// parsing, +, - and * are constexpr. Results that do not fit throw
+// std::overflow_error.
+//
+// Large constants can therefore be computed at compile time and used as
+// int2048 without parsing or allocating at startup:
+//
+//   static constexpr auto P = 2305843009213693951_fixed * 3_fixed;
+//   int2048 p = P.view();
+
+#include "int2048.h"
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace sjtu {
+
+// Limbs needed for every value of up to bits bits (log10(2) < 0.30103)
+constexpr std::size_t limbs_for_bits(std::size_t bits) {
+  return (bits * 30103 / 100000 + 1 + 8) / 9;
+}
+
+template <std::size_t Limbs> class fixed_int {
+  static_assert(Limbs > 0, "fixed_int needs at least one limb");
+
+public:
+  static constexpr std::size_t LIMBS = Limbs;
+  static constexpr int BASE = 1000000000;
+
+  constexpr fixed_int() : negative_(false), limbs_() {}
+
+  constexpr fixed_int(long long value) : negative_(value < 0), limbs_() {
+    // Negate in unsigned arithmetic so LLONG_MIN works
+    unsigned long long magnitude = value < 0 ? 0 - (unsigned long long)value : value;
+    for (std::size_t i = 0; magnitude; ++i) {
+      if (i == Limbs) throw std::overflow_error("fixed_int: value too large");
+      limbs_[i] = magnitude % BASE;
+      magnitude /= BASE;
+    }
+  }
+
+  // Widening is implicit, so operands of mixed widths combine at the wider
+  // one; narrowing throws std::overflow_error when the value does not fit
+  template <std::size_t Other, typename std::enable_if<(Other <= Limbs), int>::type = 0>
+  constexpr fixed_int(const fixed_int<Other> &other)
+      : negative_(other.is_negative()), limbs_(resize(other)) {}
+  template <std::size_t Other, typename std::enable_if<(Other > Limbs), int>::type = 0>
+  constexpr explicit fixed_int(const fixed_int<Other> &other)
+      : negative_(other.is_negative()), limbs_(resize(other)) {}
+
+  // An optional sign followed by decimal digits; digit separators (') are
+  // skipped. Throws std::invalid_argument for anything else, so a bad
+  // constant fails to compile, and std::overflow_error when it is too large.
+  constexpr explicit fixed_int(std::string_view text) : negative_(false), limbs_() {
+    std::size_t first = !text.empty() && (text[0] == '-' || text[0] == '+');
+    if (first == text.size()) throw std::invalid_argument("fixed_int: no digits");
+    std::size_t limb = 0;
+    int power = 1;
+    for (std::size_t i = text.size(); i-- > first;) {
+      char c = text[i];
+      if (c == '\'') continue;
+      if (c < '0' || c > '9') throw std::invalid_argument("fixed_int: invalid digit");
+      if (c != '0') {
+        if (limb == Limbs) throw std::overflow_error("fixed_int: value too large");
+        limbs_[limb] += (c - '0') * power;
+      }
+      power *= 10;
+      if (power == BASE) {
+        power = 1;
+        ++limb;
+      }
+    }
+    negative_ = text[0] == '-' && !is_zero();
+  }
+
+  // Throws std::overflow_error when value needs more than Limbs limbs
+  explicit fixed_int(const int2048 &value) : negative_(!value.sign), limbs_() {
+    if (value.digits.size() > Limbs) throw std::overflow_error("fixed_int: value too large");
+    for (std::size_t i = 0; i < value.digits.size(); ++i) {
+      limbs_[i] = value.digits[i];
+    }
+  }
+
+  explicit operator int2048() const {
+    int2048 result;
+    std::size_t n = used();
+    result.digits.assign(n ? n : 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+      result.digits[i] = limbs_[i];
+    }
+    result.sign = !negative_;
+    return result;
+  }
+
+  // An int2048 that refers to these limbs instead of copying them, like
+  // int2048::view(). *this must outlive the result and every copy of it,
+  // which a static constexpr constant does; the first write copies.
+  int2048 view() const {
+    int2048 result;
+    std::size_t n = used();
+    result.digits.borrow(limbs_.data(), n ? n : 1);
+    result.sign = !negative_;
+    return result;
+  }
+
+  // Limb i of |x|, least significant first
+  constexpr int limb(std::size_t i) const { return limbs_[i]; }
+  constexpr bool is_negative() const { return negative_; }
+  constexpr bool is_zero() const { return used() == 0; }
+
+  constexpr fixed_int operator+() const { return *this; }
+  constexpr fixed_int operator-() const {
+    fixed_int result = *this;
+    result.negative_ = !negative_ && !is_zero();
+    return result;
+  }
+
+  constexpr fixed_int &operator+=(const fixed_int &other) {
+    return accumulate(other, other.negative_);
+  }
+  constexpr fixed_int &operator-=(const fixed_int &other) {
+    return accumulate(other, !other.negative_);
+  }
+
+  constexpr fixed_int &operator*=(const fixed_int &other) {
+    std::size_t na = used(), nb = other.used();
+    if (na == 0 || nb == 0) return *this = fixed_int();
+    // The product has na + nb - 1 or na + nb limbs
+    if (na + nb - 1 > Limbs) throw std::overflow_error("fixed_int: product too large");
+
+    std::array<int, Limbs> product{};
+    for (std::size_t i = 0; i < na; ++i) {
+      unsigned long long carry = 0;
+      for (std::size_t j = 0; j < nb; ++j) {
+        unsigned long long cur =
+            product[i + j] + (unsigned long long)limbs_[i] * other.limbs_[j] + carry;
+        product[i + j] = cur % BASE;
+        carry = cur / BASE;
+      }
+      if (carry) {
+        if (i + nb == Limbs) throw std::overflow_error("fixed_int: product too large");
+        product[i + nb] = carry;
+      }
+    }
+    limbs_ = product;
+    negative_ = negative_ != other.negative_;
+    return *this;
+  }
+
+  friend constexpr fixed_int operator+(fixed_int a, const fixed_int &b) { return a += b; }
+  friend constexpr fixed_int operator-(fixed_int a, const fixed_int &b) { return a -= b; }
+  friend constexpr fixed_int operator*(fixed_int a, const fixed_int &b) { return a *= b; }
+
+  // -1, 0 or 1 as a is less than, equal to or greater than b
+  friend constexpr int compare(const fixed_int &a, const fixed_int &b) {
+    if (a.negative_ != b.negative_) return a.negative_ ? -1 : 1;
+    int cmp = compare_magnitude(a, b);
+    return a.negative_ ? -cmp : cmp;
+  }
+
+  friend constexpr bool operator==(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) == 0;
+  }
+  friend constexpr bool operator!=(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) != 0;
+  }
+  friend constexpr bool operator<(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) < 0;
+  }
+  friend constexpr bool operator>(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) > 0;
+  }
+  friend constexpr bool operator<=(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) <= 0;
+  }
+  friend constexpr bool operator>=(const fixed_int &a, const fixed_int &b) {
+    return compare(a, b) >= 0;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const fixed_int &x) {
+    std::size_t n = x.used();
+    if (n == 0) return os << '0';
+    if (x.negative_) os << '-';
+    os << x.limbs_[n - 1];
+    for (std::size_t i = n - 1; i-- > 0;) {
+      char buf[10];
+      snprintf(buf, sizeof(buf), "%09d", x.limbs_[i]);
+      os << buf;
+    }
+    return os;
+  }
+
+private:
+  bool negative_;  // never set for zero
+  std::array<int, Limbs> limbs_;
+
+  // Limbs up to and including the highest non-zero one
+  constexpr std::size_t used() const {
+    std::size_t n = Limbs;
+    while (n > 0 && limbs_[n - 1] == 0) --n;
+    return n;
+  }
+
+  template <std::size_t Other>
+  static constexpr std::array<int, Limbs> resize(const fixed_int<Other> &other) {
+    std::array<int, Limbs> limbs{};
+    for (std::size_t i = 0; i < Other; ++i) {
+      if (i < Limbs) {
+        limbs[i] = other.limb(i);
+      } else if (other.limb(i) != 0) {
+        throw std::overflow_error("fixed_int: value too large");
+      }
+    }
+    return limbs;
+  }
+
+  static constexpr int compare_magnitude(const fixed_int &a, const fixed_int &b) {
+    for (std::size_t i = Limbs; i-- > 0;) {
+      if (a.limbs_[i] != b.limbs_[i]) return a.limbs_[i] < b.limbs_[i] ? -1 : 1;
+    }
+    return 0;
+  }
+
+  // *this += +-|other|, the sign of the term given by negate
+  constexpr fixed_int &accumulate(const fixed_int &other, bool negate) {
+    if (negative_ == negate) {
+      // Into a copy, so an overflow leaves *this unchanged
+      std::array<int, Limbs> sum{};
+      int carry = 0;
+      for (std::size_t i = 0; i < Limbs; ++i) {
+        int cur = limbs_[i] + other.limbs_[i] + carry;
+        carry = cur >= BASE;
+        sum[i] = carry ? cur - BASE : cur;
+      }
+      if (carry) throw std::overflow_error("fixed_int: sum too large");
+      limbs_ = sum;
+      return *this;
+    }
+
+    // Subtract the smaller magnitude from the larger one
+    int cmp = compare_magnitude(*this, other);
+    const std::array<int, Limbs> &large = cmp >= 0 ? limbs_ : other.limbs_;
+    const std::array<int, Limbs> &small = cmp >= 0 ? other.limbs_ : limbs_;
+    std::array<int, Limbs> difference{};
+    int borrow = 0;
+    for (std::size_t i = 0; i < Limbs; ++i) {
+      int cur = large[i] - small[i] - borrow;
+      borrow = cur < 0;
+      difference[i] = borrow ? cur + BASE : cur;
+    }
+    limbs_ = difference;
+    negative_ = cmp == 0 ? false : cmp > 0 ? negative_ : negate;
+    return *this;
+  }
+};
+
+namespace literals {
+
+// 123_fixed is a fixed_int just wide enough for its digits
+template <char... Chars> constexpr fixed_int<(sizeof...(Chars) + 8) / 9> operator""_fixed() {
+  constexpr char text[] = {Chars...};
+  return fixed_int<(sizeof...(Chars) + 8) / 9>(std::string_view(text, sizeof...(Chars)));
+}
+
+} // namespace literals
+
+} // namespace sjtu
+
+#endif
@@ -15,13 +15,110 @@
 #include <iostream>
 #include <vector>
 
+// Beyond the list above: the library is no longer pasted into a single
+// OJ submission (see README.md), so it may use its own headers
+#include <atomic>
+#include <memory>
+#if __cplusplus >= 202002L
+#include <compare>
+#endif
+
+#include "limb_vector.h"
+
 // 请不要使用 using namespace std;
 
 namespace sjtu {
+
+// Crossovers between the algorithms an operation can choose from. The
+// defaults come from int2048_thresholds.h, which tune.cpp regenerates for
+// the local machine. Set them once at startup.
+struct algorithm_thresholds {
+  // Multiply with Karatsuba once both factors have at least this many
+  // limbs; values below 4 are raised to 4
+  size_t karatsuba;
+  // Shifts by k bits run k/29 passes over the decimal limbs while that is
+  // below this percentage of the limb count, and go through the binary
+  // form beyond it
+  size_t decimal_shift_percent;
+};
+
+void set_algorithm_thresholds(const algorithm_thresholds &);
+const algorithm_thresholds &get_algorithm_thresholds();
+
+// Converting between the decimal limbs and the binary form used by the
+// bitwise operators and long shifts splits values in half, and needs
+// 2^(32 * 2^k) and 10^(9 * 2^k). Those powers are computed once and cached
+// for every later conversion, from any thread, while they fit in the byte
+// limit (default 64 MiB, SJTU_POWER_CACHE_LIMIT at build time). Lowering
+// the limit drops the largest powers; powers beyond it are recomputed.
+void set_power_cache_limit(size_t bytes);
+size_t get_power_cache_limit();
+// Bytes held by the cached powers
+size_t power_cache_bytes();
+void clear_power_cache();
+
+template <size_t> class fixed_int;
+
+// Thread safety: any number of threads may call const member functions and
+// operators taking const int2048 & on the same value at once; nothing they
+// cache is published unsynchronized. Changing a value needs exclusive
+// access, as for standard containers. Copies of one value on several
+// threads are safe, since shared buffers are reference counted
+// atomically. The power cache, statistics and memory counters synchronize
+// themselves; set_algorithm_thresholds, set_limb_allocator and
+// set_share_threshold must run before other threads use the library.
 class int2048 {
 private:
+    // Owner of the binary form. The first const reader to build it
+    // publishes it with a compare-and-swap, so readers on other threads see
+    // either nothing or the complete vector.
+    class binary_cache {
+    public:
+      binary_cache() : form(nullptr) {}
+      binary_cache(binary_cache &&other) noexcept : form(other.release()) {}
+      binary_cache &operator=(binary_cache &&other) noexcept {
+        reset(other.release());
+        return *this;
+      }
+      ~binary_cache() { reset(); }
+
+      std::vector<unsigned int> *get() const { return form.load(std::memory_order_acquire); }
+      explicit operator bool() const { return get() != nullptr; }
+      std::vector<unsigned int> &operator*() const { return *get(); }
+      std::vector<unsigned int> *operator->() const { return get(); }
+
+      void reset(std::vector<unsigned int> *p = nullptr) {
+        delete form.exchange(p, std::memory_order_acq_rel);
+      }
+      std::vector<unsigned int> *release() { return form.exchange(nullptr); }
+      // Install p unless another thread already installed a form; returns
+      // the installed one and frees p if it lost
+      std::vector<unsigned int> *publish(std::unique_ptr<std::vector<unsigned int>> p) {
+        std::vector<unsigned int> *expected = nullptr;
+        if (form.compare_exchange_strong(expected, p.get(), std::memory_order_acq_rel)) {
+          return p.release();
+        }
+        return expected;
+      }
+
+    private:
+      std::atomic<std::vector<unsigned int> *> form;
+    };
+
+    // Invariant kept by every operation: digits is non-empty with no zero
+    // limbs on top, and zero is positive. Comparisons rely on it.
     bool sign;  // true for positive, false for negative
-    std::vector<int> digits;  // digits in base BASE, least significant digit first
+    limb_vector digits;  // digits in base BASE, least significant digit first
+    // |value| in base 2^32, least significant word first. Filled lazily by
+    // the bitwise operators and dropped whenever the value changes.
+    mutable binary_cache binary;
+
+    const std::vector<unsigned int> &binary_view() const;
+    void assign_binary(std::vector<unsigned int> &, bool);
+    int2048 &mul_accumulate(const int2048 &, const int2048 &, bool);
+
+    // Converts to and from its own limbs (fixed_int.h)
+    template <size_t> friend class fixed_int;
 
 public:
   // 构造函数
@@ -29,6 +126,7 @@ public:
   int2048(long long);
   int2048(const std::string &);
   int2048(const int2048 &);
+  int2048(int2048 &&) noexcept;
 
   // 以下给定函数的形式参数类型仅供参考，可自行选择使用常量引用或者不使用引用
   // 如果需要，可以自行增加其他所需的函数
@@ -59,6 +157,7 @@ public:
   int2048 operator-() const;
 
   int2048 &operator=(const int2048 &);
+  int2048 &operator=(int2048 &&) noexcept;
 
   int2048 &operator+=(const int2048 &);
   friend int2048 operator+(int2048, const int2048 &);
@@ -84,6 +183,142 @@ public:
   friend bool operator>(const int2048 &, const int2048 &);
   friend bool operator<=(const int2048 &, const int2048 &);
   friend bool operator>=(const int2048 &, const int2048 &);
+
+  // -1, 0 or 1 as a is less than, equal to or greater than b. Values of
+  // different length or sign are ordered without reading their limbs.
+  friend int compare(const int2048 &, const int2048 &);
+#if __cplusplus >= 202002L
+  friend std::strong_ordering operator<=>(const int2048 &a, const int2048 &b) {
+    return compare(a, b) <=> 0;
+  }
+#endif
+
+  // ===================================
+  // Memory
+  // ===================================
+
+  // Preallocate room for a value of up to n decimal digits
+  void reserve(size_t);
+  // Release capacity beyond the current value
+  void shrink_to_fit();
+  // Bytes held by this object, including its heap buffers
+  size_t memory_usage() const;
+
+  // ===================================
+  // Binary serialization
+  // ===================================
+  // Layout, all integers little-endian:
+  //   bytes 0-3   magic "I2K" followed by the format version (1)
+  //   byte  4     1 for negative values, 0 otherwise
+  //   bytes 5-7   zero
+  //   bytes 8-15  limb count n
+  //   bytes 16-   n limbs of 4 bytes in base 10^9, least significant first
+
+  // Bytes written by serialize()
+  size_t serialized_size() const;
+  // Write the binary form to buf; returns the bytes written, or 0 when
+  // size is too small
+  size_t serialize(void *buf, size_t size) const;
+  // Read a binary form into a new value; throws std::runtime_error on
+  // malformed data
+  static int2048 deserialize(const void *buf, size_t size);
+  // Like deserialize(), but the result refers to the limbs inside buf
+  // instead of copying them. buf must stay mapped and unchanged while the
+  // result or any copy of it is alive; the first write makes a private
+  // copy. Falls back to copying when buf is not 4-byte aligned or the host
+  // is big-endian.
+  static int2048 view(const void *buf, size_t size);
+
+  // ===================================
+  // Decimal files
+  // ===================================
+
+  // Read a decimal number (optional sign, surrounding whitespace allowed)
+  // by mapping the file and parsing it straight into the limbs, on up to
+  // threads threads (0 picks the hardware concurrency). Throws
+  // std::runtime_error when the file cannot be read or is not a number.
+  static int2048 from_file(const std::string &path, unsigned threads = 1);
+  // Write the decimal form without a trailing newline
+  void to_file(const std::string &path, unsigned threads = 1) const;
+
+  // ===================================
+  // Batch operations
+  // ===================================
+
+  // Elementwise and reducing operations over arrays, split into ranges
+  // that run on library_pool() (thread_pool.h) when the arrays hold enough
+  // limbs to pay for it. Temporaries come from each thread's limb
+  // allocator; with limb_pool_allocator() every worker recycles its own.
+
+  // out[i] = a[i] * b[i] for i < n; out may be a or b
+  static void multiply_many(const int2048 *a, const int2048 *b, int2048 *out, size_t n);
+  // values[0] + ... + values[n - 1], adding pairs of partial sums in a
+  // balanced tree
+  static int2048 sum(const int2048 *values, size_t n);
+  // out[i] = values[0] + ... + values[i] for i < n; out may be values
+  static void prefix_sum(const int2048 *values, int2048 *out, size_t n);
+
+  // ===================================
+  // Fused multiply-add
+  // ===================================
+
+  // *this += a * b, without building the product for small operands
+  int2048 &addmul(const int2048 &, const int2048 &);
+  // *this -= a * b
+  int2048 &submul(const int2048 &, const int2048 &);
+  // Return acc + a * b
+  friend int2048 fma(int2048, const int2048 &, const int2048 &);
+
+  // *this = sum of count terms, term i negated when negate[i] is set, in
+  // a single carry pass. Any term may alias *this.
+  int2048 &assign_sum(const int2048 *const *terms, const bool *negate, size_t count);
+
+  // ===================================
+  // Bitwise operations
+  // ===================================
+  // Negative numbers behave as infinite two's complement, so x >> k is
+  // floor(x / 2^k) and ~x == -x - 1.
+
+  int2048 operator~() const;
+
+  int2048 &operator<<=(long long);
+  friend int2048 operator<<(int2048, long long);
+
+  int2048 &operator>>=(long long);
+  friend int2048 operator>>(int2048, long long);
+
+  int2048 &operator&=(const int2048 &);
+  friend int2048 operator&(int2048, const int2048 &);
+
+  int2048 &operator|=(const int2048 &);
+  friend int2048 operator|(int2048, const int2048 &);
+
+  int2048 &operator^=(const int2048 &);
+  friend int2048 operator^(int2048, const int2048 &);
+
+  // Number of bits needed to represent |x| (0 for zero)
+  long long bit_length() const;
+  // Number of set bits in |x|
+  long long popcount() const;
+
+  // ===================================
+  // Decimal shifts
+  // ===================================
+
+  // Multiply by 10^k
+  int2048 &mul_pow10(long long);
+  // Divide by 10^k, rounding toward negative infinity like operator/
+  int2048 &div_pow10(long long);
+  // mul_pow10(k) for k >= 0, div_pow10(-k) otherwise
+  int2048 &shift10(long long);
+
+  // ===================================
+  // Hashing
+  // ===================================
+
+  // Hash of the value, equal for equal values; also used by
+  // std::hash<int2048> (int2048_hash.h)
+  size_t hash() const noexcept;
 };
 } // namespace sjtu
 
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef SJTU_INT2048_ASYNC
+#define SJTU_INT2048_ASYNC
+
+// Long-running int2048 operations on library_pool() (thread_pool.h), with
+// cooperative cancellation. To enforce a deadline:
+//
+//   sjtu::cancel_token token;
+//   std::future<sjtu::int2048> q = sjtu::async_divide(a, b, token);
+//   if (q.wait_for(std::chrono::seconds(2)) == std::future_status::timeout) {
+//     token.cancel();  // q.get() now throws sjtu::operation_cancelled
+//   }
+//
+// A cancelled operation stops at its next check (int2048_cancel.h):
+//  - before it starts, and at every squaring of a power;
+//  - in a multiplication, at every Karatsuba split and every 2^16 limb
+//    products of a schoolbook product, so between two checks it does
+//    O(2^16 + n) work for a factor of n limbs;
+//  - in a division, at every quotient limb, which costs O(n) for a
+//    divisor of n limbs.
+// Operands are copied (or shared, for large ones) into the task, so the
+// caller may change or destroy its own.
+
+#include "int2048.h"
+#include "int2048_cancel.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+namespace sjtu {
+
+namespace detail {
+class cancel_scope;
+}
+
+// A cancellation flag shared by the copies of a token; cancelling any copy
+// cancels every operation started with one of them
+class cancel_token {
+public:
+  cancel_token() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void cancel() { flag->store(true, std::memory_order_relaxed); }
+  bool cancelled() const { return flag->load(std::memory_order_relaxed); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> flag;
+  friend class detail::cancel_scope;
+};
+
+// a * b
+std::future<int2048> async_multiply(int2048 a, int2048 b, cancel_token token = cancel_token());
+// a / b, rounded toward negative infinity like operator/
+std::future<int2048> async_divide(int2048 a, int2048 b, cancel_token token = cancel_token());
+// base^exponent by repeated squaring; 0^0 is 1
+std::future<int2048> async_pow(int2048 base, unsigned long long exponent,
+                               cancel_token token = cancel_token());
+
+namespace detail {
+
+// Makes token the flag checked on this thread while in scope
+class cancel_scope {
+public:
+  explicit cancel_scope(const cancel_token &token) : saved(cancel_flag) {
+    cancel_flag = token.flag.get();
+  }
+  ~cancel_scope() { cancel_flag = saved; }
+
+  cancel_scope(const cancel_scope &) = delete;
+  cancel_scope &operator=(const cancel_scope &) = delete;
+
+private:
+  const std::atomic<bool> *saved;
+};
+
+} // namespace detail
+
+} // namespace sjtu
+
+#endif
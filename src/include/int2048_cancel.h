@@ -0,0 +1,35 @@
+#pragma once
+#ifndef SJTU_INT2048_CANCEL
+#define SJTU_INT2048_CANCEL
+
+// The cancellation checks inside the arithmetic kernels. The flag is set
+// by the asynchronous operations in int2048_async.h; code that does not
+// use them never sets it and only pays for a thread-local load per check.
+
+#include <atomic>
+#include <stdexcept>
+
+namespace sjtu {
+
+class operation_cancelled : public std::runtime_error {
+public:
+  operation_cancelled() : std::runtime_error("int2048 operation cancelled") {}
+};
+
+namespace detail {
+
+// The flag of the asynchronous operation running on this thread, if any
+extern thread_local const std::atomic<bool> *cancel_flag;
+
+[[noreturn]] void throw_cancelled();
+
+// Throws operation_cancelled once the running operation is cancelled
+inline void check_cancelled() {
+  if (cancel_flag && cancel_flag->load(std::memory_order_relaxed)) throw_cancelled();
+}
+
+} // namespace detail
+
+} // namespace sjtu
+
+#endif
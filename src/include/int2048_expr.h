@@ -0,0 +1,221 @@
+#pragma once
+#ifndef SJTU_BIGINTEGER_EXPR
+#define SJTU_BIGINTEGER_EXPR
+
+// Opt-in lazy expressions over int2048.
+//
+//   using sjtu::expr::lazy;
+//   sjtu::expr::assign(x, lazy(a) + b - lazy(c) * d);
+//
+// The expression tree is flattened into signed terms and signed products.
+// All plain terms are summed into the destination in one carry pass
+// (int2048::assign_sum) and every product is then accumulated with
+// addmul/submul, so no intermediate sums are built. Factors that are
+// themselves compound expressions are evaluated into temporaries first.
+
+#include "int2048.h"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace sjtu {
+namespace expr {
+
+template <class E> struct expression {
+  const E &self() const { return static_cast<const E &>(*this); }
+
+  // Evaluate into a fresh int2048
+  operator int2048() const;
+};
+
+struct ref : expression<ref> {
+  const int2048 *value;
+  explicit ref(const int2048 &v) : value(&v) {}
+};
+
+template <class L, class R> struct sum : expression<sum<L, R>> {
+  L lhs;
+  R rhs;
+  sum(const L &l, const R &r) : lhs(l), rhs(r) {}
+};
+
+template <class L, class R> struct difference : expression<difference<L, R>> {
+  L lhs;
+  R rhs;
+  difference(const L &l, const R &r) : lhs(l), rhs(r) {}
+};
+
+template <class L, class R> struct product : expression<product<L, R>> {
+  L lhs;
+  R rhs;
+  product(const L &l, const R &r) : lhs(l), rhs(r) {}
+};
+
+template <class E> struct negation : expression<negation<E>> {
+  E operand;
+  explicit negation(const E &e) : operand(e) {}
+};
+
+inline ref lazy(const int2048 &value) { return ref(value); }
+
+// Operators: at least one side must already be an expression, so plain
+// int2048 arithmetic is never captured by accident.
+
+template <class L, class R>
+sum<L, R> operator+(const expression<L> &l, const expression<R> &r) {
+  return sum<L, R>(l.self(), r.self());
+}
+template <class L> sum<L, ref> operator+(const expression<L> &l, const int2048 &r) {
+  return sum<L, ref>(l.self(), ref(r));
+}
+template <class R> sum<ref, R> operator+(const int2048 &l, const expression<R> &r) {
+  return sum<ref, R>(ref(l), r.self());
+}
+
+template <class L, class R>
+difference<L, R> operator-(const expression<L> &l, const expression<R> &r) {
+  return difference<L, R>(l.self(), r.self());
+}
+template <class L>
+difference<L, ref> operator-(const expression<L> &l, const int2048 &r) {
+  return difference<L, ref>(l.self(), ref(r));
+}
+template <class R>
+difference<ref, R> operator-(const int2048 &l, const expression<R> &r) {
+  return difference<ref, R>(ref(l), r.self());
+}
+
+template <class L, class R>
+product<L, R> operator*(const expression<L> &l, const expression<R> &r) {
+  return product<L, R>(l.self(), r.self());
+}
+template <class L> product<L, ref> operator*(const expression<L> &l, const int2048 &r) {
+  return product<L, ref>(l.self(), ref(r));
+}
+template <class R> product<ref, R> operator*(const int2048 &l, const expression<R> &r) {
+  return product<ref, R>(ref(l), r.self());
+}
+
+template <class E> negation<E> operator-(const expression<E> &e) {
+  return negation<E>(e.self());
+}
+
+// Compile-time count of terms, products and temporaries in an expression
+
+template <class E> struct shape;
+
+template <> struct shape<ref> {
+  static const std::size_t terms = 1, products = 0, temps = 0;
+};
+
+template <class L, class R> struct shape<sum<L, R>> {
+  static const std::size_t terms = shape<L>::terms + shape<R>::terms;
+  static const std::size_t products = shape<L>::products + shape<R>::products;
+  static const std::size_t temps = shape<L>::temps + shape<R>::temps;
+};
+
+template <class L, class R> struct shape<difference<L, R>> : shape<sum<L, R>> {};
+
+template <class E> struct shape<negation<E>> : shape<E> {};
+
+template <class E> struct factor_temps {
+  static const std::size_t value = 1;
+};
+template <> struct factor_temps<ref> {
+  static const std::size_t value = 0;
+};
+
+template <class L, class R> struct shape<product<L, R>> {
+  static const std::size_t terms = 0, products = 1;
+  static const std::size_t temps = factor_temps<L>::value + factor_temps<R>::value;
+};
+
+template <class E> struct linear_form {
+  std::array<const int2048 *, shape<E>::terms> terms;
+  std::array<bool, shape<E>::terms> term_negate;
+  std::size_t term_count = 0;
+
+  std::array<const int2048 *, shape<E>::products> lhs, rhs;
+  std::array<bool, shape<E>::products> product_negate;
+  std::size_t product_count = 0;
+
+  std::array<int2048, shape<E>::temps> temps;
+  std::size_t temp_count = 0;
+};
+
+template <class E> int2048 &assign(int2048 &, const expression<E> &);
+
+template <class F> const int2048 *factor(const ref &r, F &) { return r.value; }
+
+template <class E, class F> const int2048 *factor(const expression<E> &e, F &form) {
+  int2048 &temp = form.temps[form.temp_count++];
+  assign(temp, e);
+  return &temp;
+}
+
+template <class F> void collect(const ref &r, bool negate, F &form) {
+  form.terms[form.term_count] = r.value;
+  form.term_negate[form.term_count++] = negate;
+}
+
+template <class L, class R, class F>
+void collect(const sum<L, R> &e, bool negate, F &form) {
+  collect(e.lhs, negate, form);
+  collect(e.rhs, negate, form);
+}
+
+template <class L, class R, class F>
+void collect(const difference<L, R> &e, bool negate, F &form) {
+  collect(e.lhs, negate, form);
+  collect(e.rhs, !negate, form);
+}
+
+template <class E, class F> void collect(const negation<E> &e, bool negate, F &form) {
+  collect(e.operand, !negate, form);
+}
+
+template <class L, class R, class F>
+void collect(const product<L, R> &e, bool negate, F &form) {
+  form.lhs[form.product_count] = factor(e.lhs, form);
+  form.rhs[form.product_count] = factor(e.rhs, form);
+  form.product_negate[form.product_count++] = negate;
+}
+
+// Evaluate e into dest, reusing dest's limb buffer. dest may appear
+// anywhere in the expression.
+template <class E> int2048 &assign(int2048 &dest, const expression<E> &e) {
+  linear_form<E> form;
+  collect(e.self(), false, form);
+
+  // The sum pass overwrites dest, so a product reading dest needs a
+  // separate target
+  bool aliased = false;
+  for (std::size_t i = 0; i < form.product_count; ++i) {
+    aliased |= form.lhs[i] == &dest || form.rhs[i] == &dest;
+  }
+  int2048 scratch;
+  int2048 &out = aliased ? scratch : dest;
+
+  out.assign_sum(form.terms.data(), form.term_negate.data(), form.term_count);
+  for (std::size_t i = 0; i < form.product_count; ++i) {
+    if (form.product_negate[i]) {
+      out.submul(*form.lhs[i], *form.rhs[i]);
+    } else {
+      out.addmul(*form.lhs[i], *form.rhs[i]);
+    }
+  }
+  if (aliased) dest = std::move(scratch);
+  return dest;
+}
+
+template <class E> expression<E>::operator int2048() const {
+  int2048 result;
+  assign(result, *this);
+  return result;
+}
+
+} // namespace expr
+} // namespace sjtu
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+#ifndef SJTU_INT2048_HASH
+#define SJTU_INT2048_HASH
+
+// std::hash<sjtu::int2048>, so int2048 can key unordered containers. Kept
+// out of int2048.h, whose standard headers are limited to the OJ's list.
+
+#include "int2048.h"
+
+#include <functional>
+
+namespace std {
+template <> struct hash<sjtu::int2048> {
+  size_t operator()(const sjtu::int2048 &x) const noexcept { return x.hash(); }
+};
+} // namespace std
+
+#endif
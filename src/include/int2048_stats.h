@@ -0,0 +1,125 @@
+#pragma once
+#ifndef SJTU_INT2048_STATS
+#define SJTU_INT2048_STATS
+
+// Optional operation counters for int2048. Build the library with
+// -DSJTU_INT2048_INSTRUMENT to record, per operation and per algorithm
+// tier, the number of calls, the limbs they processed and the time spent.
+// Without it the hooks compile to nothing and no counters are kept.
+//
+// Times include nested operations: operator% counts the division it runs,
+// and minus() the add() it runs. The algorithm tiers inside an operation
+// (multiply.*, divide.limb_search) and allocations only count calls and
+// limbs; their time is part of the operation that ran them.
+//
+// Building with -DSJTU_INT2048_TRACK_MEMORY also keeps these counters and
+// additionally tracks the bytes held by heap limb buffers: live and peak
+// totals, the largest growth above its starting point seen during each
+// top-level operation, and an optional budget that aborts the process
+// with a diagnostic when exceeded. Per-operation peaks are attributed per
+// thread but measured against the process-wide total, so they are exact
+// only while one thread at a time does arithmetic.
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+namespace sjtu {
+
+enum stat_id {
+  STAT_READ,                 // read(), operator>>
+  STAT_PRINT,                // print(), operator<<
+  STAT_ADD,                  // add(), +=, +
+  STAT_MINUS,                // minus(), -=, -
+  STAT_MULTIPLY,             // *=, *
+  STAT_MULTIPLY_SCHOOLBOOK,  // schoolbook products, including Karatsuba leaves
+  STAT_MULTIPLY_KARATSUBA,   // Karatsuba nodes
+  STAT_DIVIDE,               // /=, /
+  STAT_DIVIDE_LIMB_SEARCH,   // binary searches for one quotient limb
+  STAT_MODULO,               // %=, %
+  STAT_FUSED_MULTIPLY_ADD,   // addmul(), submul(), fma()
+  STAT_SHIFT_DECIMAL,        // <<=, >>= on the decimal limbs
+  STAT_SHIFT_BINARY,         // <<=, >>= through the binary form
+  STAT_BITWISE,              // &, |, ^
+  STAT_SHIFT10,              // mul_pow10(), div_pow10(), shift10()
+  STAT_FILE_READ,            // from_file()
+  STAT_FILE_WRITE,           // to_file()
+  STAT_ALLOCATE,             // heap limb buffers; limbs is their capacity
+  STAT_COUNT
+};
+
+struct operation_stats {
+  const char *name;
+  unsigned long long calls;
+  unsigned long long limbs;
+  unsigned long long nanoseconds;
+  // Most limb buffer bytes added while this was the outermost operation;
+  // only filled with SJTU_INT2048_TRACK_MEMORY
+  std::size_t peak_bytes;
+};
+
+struct memory_stats {
+  std::size_t live_bytes;
+  std::size_t peak_bytes;
+};
+
+// Whether the library keeps the counters (SJTU_INT2048_INSTRUMENT or
+// SJTU_INT2048_TRACK_MEMORY)
+bool stats_enabled();
+// Whether the library was built with SJTU_INT2048_TRACK_MEMORY
+bool memory_tracking_enabled();
+// Current counters, one entry per stat_id in order
+std::vector<operation_stats> get_stats();
+// Zero every counter; the memory peak restarts from the live bytes
+void reset_stats();
+// Write a table of the operations that ran
+void dump_stats(std::ostream &);
+
+// Bytes held by heap limb buffers, zero unless tracking memory
+memory_stats get_memory_stats();
+// Abort once the limb buffers would hold more than this many bytes; 0,
+// the default, means no limit
+void set_memory_budget(std::size_t bytes);
+
+namespace detail {
+
+void record_stat(stat_id, std::size_t limbs, unsigned long long nanoseconds);
+void record_allocation(std::size_t bytes);
+void record_release(std::size_t bytes);
+
+// Records one call of an operation, timed from construction to destruction
+class stat_scope {
+public:
+  stat_scope(stat_id id, std::size_t limbs);
+  ~stat_scope();
+
+private:
+  stat_id id_;
+  std::size_t limbs_;
+  unsigned long long start_;
+  std::size_t peak_start_;  // live bytes when the outermost scope began
+};
+
+} // namespace detail
+} // namespace sjtu
+
+// Hooks used inside the library. The limbs expression is not evaluated
+// when instrumentation is off.
+#if defined(SJTU_INT2048_INSTRUMENT) || defined(SJTU_INT2048_TRACK_MEMORY)
+#define SJTU_STAT_COUNT(id, limbs) ::sjtu::detail::record_stat(::sjtu::id, (limbs), 0)
+#define SJTU_STAT_SCOPE(id, limbs) \
+  ::sjtu::detail::stat_scope sjtu_stat_scope_(::sjtu::id, (limbs))
+#else
+#define SJTU_STAT_COUNT(id, limbs) ((void)0)
+#define SJTU_STAT_SCOPE(id, limbs) ((void)0)
+#endif
+
+#ifdef SJTU_INT2048_TRACK_MEMORY
+#define SJTU_MEMORY_ALLOCATE(bytes) ::sjtu::detail::record_allocation(bytes)
+#define SJTU_MEMORY_RELEASE(bytes) ::sjtu::detail::record_release(bytes)
+#else
+#define SJTU_MEMORY_ALLOCATE(bytes) ((void)0)
+#define SJTU_MEMORY_RELEASE(bytes) ((void)0)
+#endif
+
+#endif
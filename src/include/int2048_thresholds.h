@@ -0,0 +1,17 @@
+#pragma once
+#ifndef SJTU_INT2048_THRESHOLDS
+#define SJTU_INT2048_THRESHOLDS
+
+// Default algorithm crossovers for int2048 (see algorithm_thresholds in
+// int2048.h). Generated by tune.cpp; rerun it on the target machine with
+// --write to refresh, or override a value with -D at build time.
+
+#ifndef SJTU_KARATSUBA_THRESHOLD
+#define SJTU_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef SJTU_DECIMAL_SHIFT_PERCENT
+#define SJTU_DECIMAL_SHIFT_PERCENT 400
+#endif
+
+#endif
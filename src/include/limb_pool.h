@@ -0,0 +1,27 @@
+#pragma once
+#ifndef SJTU_LIMB_POOL
+#define SJTU_LIMB_POOL
+
+#include "limb_vector.h"
+
+namespace sjtu {
+
+// A limb allocator that keeps freed buffers in per-thread free lists, one
+// per power-of-two size class, so temporaries made by the arithmetic
+// kernels are recycled without touching the global heap. Buffers above
+// the largest class, and frees beyond each list's byte cap, go straight
+// to operator new/delete. A buffer freed on another thread joins that
+// thread's lists.
+//
+//   sjtu::set_limb_allocator(sjtu::limb_pool_allocator());
+limb_allocator limb_pool_allocator();
+
+// Return the calling thread's cached buffers to the global heap
+void release_limb_pool();
+
+// Bytes currently cached by the calling thread
+std::size_t limb_pool_cached_bytes();
+
+} // namespace sjtu
+
+#endif
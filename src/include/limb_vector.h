@@ -0,0 +1,179 @@
+#pragma once
+#ifndef SJTU_LIMB_VECTOR
+#define SJTU_LIMB_VECTOR
+
+#include <cstddef>
+#include <cstring>
+
+namespace sjtu {
+
+// Hooks used for every new heap limb buffer. Each buffer remembers the
+// hooks that allocated it and is released through those, so allocators may
+// be swapped at any time, from any thread, while older buffers are alive.
+struct limb_allocator {
+  void *(*allocate)(std::size_t bytes);
+  void (*deallocate)(void *p, std::size_t bytes);
+};
+
+void set_limb_allocator(const limb_allocator &);
+const limb_allocator &get_limb_allocator();
+
+// Copies of heap buffers with at least this many limbs share the buffer
+// until one side writes to it. Set once at startup; 0 shares every heap
+// buffer and -1 turns sharing off.
+void set_share_threshold(std::size_t limbs);
+std::size_t get_share_threshold();
+
+// A std::vector<int>-like container for limbs that keeps up to
+// INLINE_CAPACITY limbs inside the object and only allocates beyond that.
+// Large heap buffers are reference counted and copied on the first write
+// through a non-const accessor. A vector may also borrow limbs it does not
+// own (see borrow()), which are likewise copied on the first write.
+class limb_vector {
+public:
+  typedef int value_type;
+  typedef int *iterator;
+  typedef const int *const_iterator;
+  typedef std::size_t size_type;
+
+  static const size_type INLINE_CAPACITY = 4;
+
+  limb_vector() : size_(0), capacity_(INLINE_CAPACITY) {}
+  limb_vector(size_type n, int value) : size_(0), capacity_(INLINE_CAPACITY) {
+    resize(n, value);
+  }
+  limb_vector(const int *first, const int *last) : size_(0), capacity_(INLINE_CAPACITY) {
+    copy_from(first, last - first);
+  }
+  limb_vector(const limb_vector &other) : size_(0), capacity_(INLINE_CAPACITY) {
+    if (shareable(other)) {
+      share(other);
+    } else {
+      copy_from(other.data(), other.size_);
+    }
+  }
+  limb_vector(limb_vector &&other) noexcept : size_(0), capacity_(INLINE_CAPACITY) {
+    swap(other);
+  }
+  ~limb_vector() { reset(); }
+
+  limb_vector &operator=(const limb_vector &other) {
+    if (this != &other) {
+      if (shareable(other)) {
+        reset();
+        share(other);
+      } else {
+        // Never write into a buffer someone else still reads
+        if (!is_inline() && is_shared()) reset();
+        size_ = 0;
+        copy_from(other.data(), other.size_);
+      }
+    }
+    return *this;
+  }
+  limb_vector &operator=(limb_vector &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  bool is_inline() const { return capacity_ == INLINE_CAPACITY; }
+  // Whether the heap buffer may be shared with another limb_vector
+  bool is_shared() const { return __atomic_load_n(&heap_.shared, __ATOMIC_RELAXED); }
+
+  size_type size() const { return size_; }
+  size_type capacity() const { return capacity_; }
+  // Sizes are stored in 32 bits to keep the object small; asking for more
+  // limbs than this throws std::length_error
+  static size_type max_size() { return 0xffffffffu; }
+  bool empty() const { return size_ == 0; }
+
+  int *data() {
+    if (is_inline()) return inline_;
+    if (is_shared()) unshare();
+    return heap_.limbs;
+  }
+  const int *data() const { return is_inline() ? inline_ : heap_.limbs; }
+
+  int &operator[](size_type i) { return data()[i]; }
+  const int &operator[](size_type i) const { return data()[i]; }
+  int &back() { return data()[size_ - 1]; }
+  const int &back() const { return data()[size_ - 1]; }
+
+  iterator begin() { return data(); }
+  iterator end() { return data() + size_; }
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size_; }
+
+  void push_back(int value) {
+    if (size_ == capacity_) grow(size_type(size_) + 1);
+    data()[size_++] = value;
+  }
+  void pop_back() { --size_; }
+  void clear() { size_ = 0; }
+
+  void resize(size_type n, int value = 0) {
+    if (n > capacity_) grow(n);
+    int *p = data();
+    for (size_type i = size_; i < n; ++i) p[i] = value;
+    size_ = n;
+  }
+  void assign(size_type n, int value) {
+    size_ = 0;
+    resize(n, value);
+  }
+  iterator insert(iterator pos, int value);
+
+  // Make room for at least n limbs without further allocation
+  void reserve(size_type n) {
+    if (n > capacity_) reallocate(n);
+  }
+  // Refer to n limbs owned by someone else, who must keep them alive and
+  // unchanged for as long as this vector or a copy of it reads them
+  void borrow(const int *limbs, size_type n);
+  bool is_borrowed() const { return !is_inline() && heap_.borrowed; }
+
+  // Drop unused capacity, moving back inline when the limbs fit
+  void shrink_to_fit();
+  // Bytes held outside the object; a shared buffer counts in full for
+  // every owner and borrowed limbs count as none
+  size_type heap_bytes() const;
+
+  void swap(limb_vector &other) noexcept;
+
+private:
+  struct heap_buffer {
+    int *limbs;  // preceded by a buffer_header unless borrowed
+    mutable bool shared;
+    bool borrowed;
+  };
+
+  unsigned int size_;
+  unsigned int capacity_;  // INLINE_CAPACITY exactly when stored inline
+  union {
+    heap_buffer heap_;
+    int inline_[INLINE_CAPACITY];
+  };
+
+  static bool shareable(const limb_vector &other) {
+    return !other.is_inline() &&
+           (other.heap_.borrowed || other.size_ >= get_share_threshold());
+  }
+
+  void copy_from(const int *first, size_type n) {
+    reserve(n);
+    std::memcpy(data(), first, n * sizeof(int));
+    size_ = n;
+  }
+  void share(const limb_vector &other);
+  void unshare();
+  void reset();
+  void grow(size_type min_capacity);
+  void reallocate(size_type new_capacity);
+
+  static int *allocate(size_type n);
+  static void release(int *p, size_type n);
+};
+
+} // namespace sjtu
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef SJTU_REGISTER_MACHINE
+#define SJTU_REGISTER_MACHINE
+
+#include "int2048.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sjtu {
+
+// A small interpreter over named int2048 registers. A program is compiled
+// once into instructions that refer to registers by index, so loops run
+// without re-parsing or printing intermediates, and every compound
+// assignment maps onto the matching in-place int2048 operator.
+//
+// One statement per line; '#' starts a comment:
+//
+//   x = 12345            assign a literal or another register
+//   x op= y              op is + - * / % & | ^, y a register or literal
+//   x <<= 5, x >>= 5     shift by a literal amount
+//   x = y op z           binary operation into x; x may be y or z
+//   print x              write x and a newline
+//   repeat 1000          run the lines up to the matching "end" 1000 times
+//   end
+//
+// Registers are created on first use with value 0 and keep their values
+// across run() calls.
+class register_machine {
+public:
+  // Compile and run program, writing print output to out. Throws
+  // std::runtime_error naming the line for syntax errors, and passes on
+  // errors from int2048 such as division by zero.
+  void run(const std::string &program, std::ostream &out);
+
+  // The register called name, created if needed
+  int2048 &operator[](const std::string &name);
+  // The register called name, or nullptr
+  const int2048 *find(const std::string &name) const;
+
+  // Remove every register
+  void clear();
+
+private:
+  enum opcode {
+    ASSIGN, ADD, SUB, MUL, DIV, MOD, AND, OR, XOR, SHL, SHR, PRINT, REPEAT, END
+  };
+
+  // Registers are indices >= 0; literal i of the program is ~i. Compound
+  // assignments are stored as x = x op y and shifts read lhs only.
+  struct instruction {
+    opcode op;
+    long dst;
+    long lhs;
+    long rhs;
+    long long count; // shift amount or repeat count
+    size_t jump;     // REPEAT: index of its END; END: index of its REPEAT
+  };
+
+  std::map<std::string, size_t> names;
+  std::deque<int2048> registers;  // a deque keeps references stable
+  int2048 scratch;
+
+  size_t register_index(const std::string &name);
+  void execute(const std::vector<instruction> &code, const std::vector<int2048> &literals,
+               std::ostream &out);
+  void apply(opcode op, int2048 &dst, const int2048 &value, long long count);
+};
+
+} // namespace sjtu
+
+#endif
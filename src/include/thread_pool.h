@@ -0,0 +1,78 @@
+#pragma once
+#ifndef SJTU_THREAD_POOL
+#define SJTU_THREAD_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sjtu {
+
+// A fixed set of worker threads with one task deque each. A worker runs
+// its own tasks newest first and, once it has none, steals the oldest task
+// of another worker, so work split off by a task stays on its thread until
+// some other thread is idle. A thread in parallel_for() works through the
+// call's own ranges alongside the workers and then sleeps until the last
+// one finishes; it never picks up unrelated tasks, so a batch call cannot
+// get stuck behind a long asynchronous job, and nested calls from inside
+// a task cannot deadlock.
+class thread_pool {
+public:
+  // threads == 0 picks the hardware concurrency
+  explicit thread_pool(unsigned threads = 0);
+  // Runs the tasks still queued, then joins the workers
+  ~thread_pool();
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  unsigned size() const { return (unsigned)workers.size(); }
+
+  // Queue task on the calling worker's deque, or on the next worker's in
+  // turn when called from another thread
+  void submit(std::function<void()> task);
+  // Run one queued task on the calling thread; false if none was queued
+  bool run_pending_task();
+
+  // Call body(first, last) over [0, count) in ranges of at least grain
+  // indices, spread over idle workers and the calling thread, and return
+  // once every range is done. The first exception thrown by body is
+  // rethrown here after the other ranges have finished.
+  void parallel_for(size_t count, size_t grain,
+                    const std::function<void(size_t, size_t)> &body);
+
+private:
+  struct task_group;
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<task_queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> next_queue;
+
+  // Sleeping workers wait for pending to turn positive. It may dip below
+  // zero while a task is taken before its submitter has counted it.
+  std::mutex idle_mutex;
+  std::condition_variable idle;
+  long pending;
+  bool stopping;
+
+  bool take(size_t home, std::function<void()> &task);
+  void work(size_t index);
+};
+
+// The pool behind the batch and asynchronous operations, started on first
+// use with one worker per hardware thread
+thread_pool &library_pool();
+
+} // namespace sjtu
+
+#endif
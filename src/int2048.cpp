@@ -1,5 +1,12 @@
 #include "include/int2048.h"
+#include "include/int2048_cancel.h"
+#include "include/int2048_stats.h"
+#include "include/int2048_thresholds.h"
 #include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 
 namespace sjtu {
@@ -7,21 +14,78 @@ namespace sjtu {
 // Use base 1000000000 (10^9) for digit compression
 static const int BASE = 1000000000;
 static const int BASE_DIGITS = 9;
+static const int POW10[BASE_DIGITS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+// Largest power of two applied per pass by the decimal shift kernels
+static const int SHIFT_STEP = 29;
+// Limbs or words from which radix conversion divides and conquers
+static const size_t CONVERT_THRESHOLD = 128;
+// Limb products of a schoolbook multiplication between cancellation checks
+static const size_t CANCEL_CHECK_PRODUCTS = 1 << 16;
+
+#ifndef SJTU_POWER_CACHE_LIMIT
+#define SJTU_POWER_CACHE_LIMIT (64u << 20)
+#endif
+
+static algorithm_thresholds thresholds = {SJTU_KARATSUBA_THRESHOLD,
+                                          SJTU_DECIMAL_SHIFT_PERCENT};
+
+void set_algorithm_thresholds(const algorithm_thresholds& t) {
+    thresholds = t;
+    thresholds.karatsuba = std::max<size_t>(thresholds.karatsuba, 4);
+}
+
+const algorithm_thresholds& get_algorithm_thresholds() {
+    return thresholds;
+}
+
+namespace detail {
+
+thread_local const std::atomic<bool>* cancel_flag = nullptr;
+
+void throw_cancelled() {
+    throw operation_cancelled();
+}
+
+} // namespace detail
+
+// Whether shifting n limbs by k bits should stay in decimal
+static bool shift_in_decimal(long long k, size_t n) {
+    return k / SHIFT_STEP < (long long)(n * thresholds.decimal_shift_percent / 100);
+}
 
 // Helper functions
-int compare_abs(const std::vector<int>& a, const std::vector<int>& b) {
+// Limbs compared per memcmp call while looking for the first difference
+static const size_t COMPARE_BLOCK = 16;
+
+// Relies on normalized limbs: a longer magnitude is the larger one
+int compare_abs(const limb_vector& a, const limb_vector& b) {
     if (a.size() != b.size()) {
         return a.size() < b.size() ? -1 : 1;
     }
-    for (int i = a.size() - 1; i >= 0; --i) {
-        if (a[i] != b[i]) {
-            return a[i] < b[i] ? -1 : 1;
+    const int* x = a.data();
+    const int* y = b.data();
+    size_t i = a.size();
+    // Random operands almost always differ in the top limb, and copies
+    // sharing one buffer are equal without a scan
+    if (x[i - 1] != y[i - 1]) return x[i - 1] < y[i - 1] ? -1 : 1;
+    if (x == y) return 0;
+
+    // Skip equal blocks from the top with memcmp, then find the limb that
+    // differs inside the first unequal block
+    while (i > 0) {
+        size_t block = std::min(i, COMPARE_BLOCK);
+        i -= block;
+        if (memcmp(x + i, y + i, block * sizeof(int)) != 0) {
+            for (size_t j = i + block; j-- > i;) {
+                if (x[j] != y[j]) return x[j] < y[j] ? -1 : 1;
+            }
         }
     }
     return 0;
 }
 
-void remove_leading_zeros(std::vector<int>& num) {
+void remove_leading_zeros(limb_vector& num) {
     while (num.size() > 1 && num.back() == 0) {
         num.pop_back();
     }
@@ -30,12 +94,235 @@ void remove_leading_zeros(std::vector<int>& num) {
     }
 }
 
+bool is_zero(const limb_vector& num) {
+    return num.size() == 1 && num[0] == 0;
+}
+
+// num *= m, for 0 < m < 2^31
+void multiply_small(limb_vector& num, int m) {
+    long long carry = 0;
+    for (int i = 0; i < num.size(); ++i) {
+        long long cur = (long long)num[i] * m + carry;
+        num[i] = cur % BASE;
+        carry = cur / BASE;
+    }
+    while (carry) {
+        num.push_back(carry % BASE);
+        carry /= BASE;
+    }
+}
+
+// num /= d, for 0 < d < 2^31; returns the remainder
+int divide_small(limb_vector& num, int d) {
+    long long rem = 0;
+    for (int i = num.size() - 1; i >= 0; --i) {
+        long long cur = num[i] + rem * BASE;
+        num[i] = cur / d;
+        rem = cur % d;
+    }
+    remove_leading_zeros(num);
+    return rem;
+}
+
+// num += 1 on the magnitude
+void increment_abs(limb_vector& num) {
+    for (int i = 0; i < num.size(); ++i) {
+        if (++num[i] < BASE) return;
+        num[i] = 0;
+    }
+    num.push_back(1);
+}
+
+// x += y * BASE^offset on magnitudes; y may alias x when offset is 0
+void add_shifted(limb_vector& x, const limb_vector& y, size_t offset) {
+    size_t y_size = y.size();
+    if (x.size() < y_size + offset) x.resize(y_size + offset, 0);
+
+    int carry = 0;
+    for (size_t i = 0; i < y_size; ++i) {
+        int sum = x[i + offset] + y[i] + carry;
+        carry = sum >= BASE;
+        x[i + offset] = carry ? sum - BASE : sum;
+    }
+    for (size_t k = offset + y_size; carry; ++k) {
+        if (k == x.size()) {
+            x.push_back(1);
+            break;
+        }
+        if (++x[k] == BASE) {
+            x[k] = 0;
+        } else {
+            carry = 0;
+        }
+    }
+}
+
+// x -= y on magnitudes, for |x| >= |y|
+void subtract_abs(limb_vector& x, const limb_vector& y) {
+    size_t y_size = y.size();
+    int borrow = 0;
+    for (size_t i = 0; i < y_size || borrow; ++i) {
+        int diff = x[i] - borrow - (i < y_size ? y[i] : 0);
+        borrow = diff < 0;
+        x[i] = borrow ? diff + BASE : diff;
+    }
+    remove_leading_zeros(x);
+}
+
+// x = y - x on magnitudes, for |y| > |x|
+void subtract_abs_from(limb_vector& x, const limb_vector& y) {
+    x.resize(y.size(), 0);
+    int borrow = 0;
+    for (size_t i = 0; i < y.size(); ++i) {
+        int diff = y[i] - x[i] - borrow;
+        borrow = diff < 0;
+        x[i] = borrow ? diff + BASE : diff;
+    }
+    remove_leading_zeros(x);
+}
+
+// Give memory back once less than a quarter of a heap buffer is in use
+void release_slack(limb_vector& num) {
+    if (!num.is_inline() && num.capacity() > 4 * num.size()) {
+        num.shrink_to_fit();
+    }
+}
+
+// Binary (base 2^32) helpers used by the bitwise operators
+
+void trim_binary(std::vector<unsigned int>& bin) {
+    while (bin.size() > 1 && bin.back() == 0) {
+        bin.pop_back();
+    }
+    if (bin.empty()) bin.push_back(0);
+}
+
+// Quadratic conversions between decimal limbs and base 2^32 words, for
+// values below CONVERT_THRESHOLD; larger ones split in half (see below)
+std::vector<unsigned int> decimal_to_binary_basecase(const limb_vector& num) {
+    std::vector<unsigned int> bin;
+    bin.reserve(num.size() * 30 / 32 + 2);
+    for (size_t i = num.size(); i-- > 0;) {
+        unsigned long long carry = num[i];
+        for (size_t j = 0; j < bin.size(); ++j) {
+            unsigned long long cur = (unsigned long long)bin[j] * BASE + carry;
+            bin[j] = (unsigned int)cur;
+            carry = cur >> 32;
+        }
+        if (carry) bin.push_back((unsigned int)carry);
+    }
+    trim_binary(bin);
+    return bin;
+}
+
+limb_vector binary_to_decimal_basecase(const std::vector<unsigned int>& bin) {
+    limb_vector num;
+    num.reserve(bin.size() * 32 / 29 + 2);
+    for (size_t i = bin.size(); i-- > 0;) {
+        unsigned long long carry = bin[i];
+        for (size_t j = 0; j < num.size(); ++j) {
+            unsigned long long cur = ((unsigned long long)num[j] << 32) + carry;
+            num[j] = cur % BASE;
+            carry = cur / BASE;
+        }
+        while (carry) {
+            num.push_back(carry % BASE);
+            carry /= BASE;
+        }
+    }
+    if (num.empty()) num.push_back(0);
+    return num;
+}
+
+std::vector<unsigned int> shift_binary_left(const std::vector<unsigned int>& bin, long long k) {
+    size_t words = k / 32;
+    int bits = k % 32;
+    std::vector<unsigned int> result(bin.size() + words + 1, 0);
+    for (size_t i = 0; i < bin.size(); ++i) {
+        unsigned long long cur = (unsigned long long)bin[i] << bits;
+        result[i + words] |= (unsigned int)cur;
+        result[i + words + 1] |= (unsigned int)(cur >> 32);
+    }
+    trim_binary(result);
+    return result;
+}
+
+// Shifts right by k bits; sets inexact when any one bit is shifted out
+std::vector<unsigned int> shift_binary_right(const std::vector<unsigned int>& bin, long long k,
+                                             bool& inexact) {
+    size_t words = k / 32;
+    int bits = k % 32;
+    inexact = false;
+    for (size_t i = 0; i < words && i < bin.size(); ++i) {
+        if (bin[i]) inexact = true;
+    }
+    if (words >= bin.size()) {
+        return std::vector<unsigned int>(1, 0);
+    }
+    if (bits && (bin[words] & ((1u << bits) - 1))) inexact = true;
+
+    std::vector<unsigned int> result(bin.size() - words);
+    for (size_t i = 0; i < result.size(); ++i) {
+        unsigned long long cur = bin[i + words];
+        if (i + words + 1 < bin.size()) {
+            cur |= (unsigned long long)bin[i + words + 1] << 32;
+        }
+        result[i] = (unsigned int)(cur >> bits);
+    }
+    trim_binary(result);
+    return result;
+}
+
+// Applies op word by word to a and b viewed as infinite two's complement
+// values. Returns the magnitude of the result and its sign in negative.
+template <class Op>
+std::vector<unsigned int> bitwise_kernel(const std::vector<unsigned int>& a, bool a_negative,
+                                         const std::vector<unsigned int>& b, bool b_negative,
+                                         Op op, bool& negative) {
+    size_t len = std::max(a.size(), b.size()) + 1;
+    std::vector<unsigned int> result(len);
+    negative = op(a_negative ? ~0u : 0u, b_negative ? ~0u : 0u) != 0;
+
+    // Two's complement of a magnitude m is ~m + 1, applied on the fly
+    unsigned long long carry_a = 1, carry_b = 1, carry_r = 1;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned int wa = i < a.size() ? a[i] : 0;
+        unsigned int wb = i < b.size() ? b[i] : 0;
+        if (a_negative) {
+            carry_a += (unsigned int)~wa;
+            wa = (unsigned int)carry_a;
+            carry_a >>= 32;
+        }
+        if (b_negative) {
+            carry_b += (unsigned int)~wb;
+            wb = (unsigned int)carry_b;
+            carry_b >>= 32;
+        }
+        unsigned int wr = op(wa, wb);
+        if (negative) {
+            carry_r += (unsigned int)~wr;
+            wr = (unsigned int)carry_r;
+            carry_r >>= 32;
+        }
+        result[i] = wr;
+    }
+    trim_binary(result);
+    return result;
+}
+
 // Karatsuba multiplication helper
-std::vector<int> multiply_karatsuba(const std::vector<int>& a, const std::vector<int>& b) {
-    if (a.size() < 8 || b.size() < 8) {
+limb_vector multiply_karatsuba(const limb_vector& a, const limb_vector& b) {
+    if (a.size() < thresholds.karatsuba || b.size() < thresholds.karatsuba) {
         // Use naive multiplication for small numbers
-        std::vector<int> result(a.size() + b.size(), 0);
+        SJTU_STAT_COUNT(STAT_MULTIPLY_SCHOOLBOOK, a.size() + b.size());
+        limb_vector result(a.size() + b.size(), 0);
+        // Unbalanced products stay here however long the larger factor is
+        size_t unchecked = 0;
         for (int i = 0; i < a.size(); ++i) {
+            if ((unchecked += b.size()) >= CANCEL_CHECK_PRODUCTS) {
+                unchecked = 0;
+                detail::check_cancelled();
+            }
             long long carry = 0;
             for (int j = 0; j < b.size() || carry; ++j) {
                 long long product = result[i + j] + carry;
@@ -50,117 +337,269 @@ std::vector<int> multiply_karatsuba(const std::vector<int>& a, const std::vector
         return result;
     }
 
+    SJTU_STAT_COUNT(STAT_MULTIPLY_KARATSUBA, a.size() + b.size());
+    detail::check_cancelled();
     int n = std::max(a.size(), b.size());
     int m = (n + 1) / 2;
 
     // Split numbers
-    std::vector<int> a_low(a.begin(), a.begin() + std::min(m, (int)a.size()));
-    std::vector<int> a_high(a.begin() + std::min(m, (int)a.size()), a.end());
-    std::vector<int> b_low(b.begin(), b.begin() + std::min(m, (int)b.size()));
-    std::vector<int> b_high(b.begin() + std::min(m, (int)b.size()), b.end());
+    limb_vector a_low(a.begin(), a.begin() + std::min(m, (int)a.size()));
+    limb_vector a_high(a.begin() + std::min(m, (int)a.size()), a.end());
+    limb_vector b_low(b.begin(), b.begin() + std::min(m, (int)b.size()));
+    limb_vector b_high(b.begin() + std::min(m, (int)b.size()), b.end());
 
     // Recursively compute three products
-    std::vector<int> z0 = multiply_karatsuba(a_low, b_low);
-    std::vector<int> z2 = multiply_karatsuba(a_high, b_high);
+    limb_vector z0 = multiply_karatsuba(a_low, b_low);
+    limb_vector z2 = multiply_karatsuba(a_high, b_high);
 
     // (a_low + a_high) * (b_low + b_high)
-    std::vector<int> a_sum = a_low;
-    std::vector<int> b_sum = b_low;
+    limb_vector a_sum;
+    a_sum.reserve(std::max(a_low.size(), a_high.size()) + 1);
+    a_sum = a_low;
+    add_shifted(a_sum, a_high, 0);
 
-    // Add a_high to a_sum
-    long long carry = 0;
-    for (int i = 0; i < a_high.size() || carry; ++i) {
-        if (i >= a_sum.size()) a_sum.push_back(0);
-        long long sum = a_sum[i] + carry;
-        if (i < a_high.size()) sum += a_high[i];
-        a_sum[i] = sum % BASE;
-        carry = sum / BASE;
-    }
-    remove_leading_zeros(a_sum);
-
-    // Add b_high to b_sum
-    carry = 0;
-    for (int i = 0; i < b_high.size() || carry; ++i) {
-        if (i >= b_sum.size()) b_sum.push_back(0);
-        long long sum = b_sum[i] + carry;
-        if (i < b_high.size()) sum += b_high[i];
-        b_sum[i] = sum % BASE;
-        carry = sum / BASE;
-    }
-    remove_leading_zeros(b_sum);
+    limb_vector b_sum;
+    b_sum.reserve(std::max(b_low.size(), b_high.size()) + 1);
+    b_sum = b_low;
+    add_shifted(b_sum, b_high, 0);
 
-    std::vector<int> z1 = multiply_karatsuba(a_sum, b_sum);
+    limb_vector z1 = multiply_karatsuba(a_sum, b_sum);
 
     // z1 = z1 - z2 - z0
-    for (int i = 0; i < z2.size(); ++i) {
-        if (i >= z1.size()) z1.push_back(0);
-        if (z1[i] < z2[i]) {
-            int j = i + 1;
-            while (j < z1.size() && z1[j] == 0) {
-                z1[j] = BASE - 1;
-                j++;
-            }
-            if (j < z1.size()) {
-                z1[j]--;
-                z1[i] += BASE;
-            }
-        }
-        z1[i] -= z2[i];
+    subtract_abs(z1, z2);
+    subtract_abs(z1, z0);
+
+    // Combine results: z0 + z1 * BASE^m + z2 * BASE^(2*m), which fits in
+    // a.size() + b.size() limbs
+    limb_vector result;
+    result.reserve(a.size() + b.size());
+    result = z0;
+    if (!is_zero(z1)) add_shifted(result, z1, m);
+    if (!is_zero(z2)) add_shifted(result, z2, 2 * m);
+
+    remove_leading_zeros(result);
+    return result;
+}
+
+// Binary multiplication, Karatsuba from the same crossover as decimal
+
+// x += y * 2^(32 * offset)
+void add_binary_shifted(std::vector<unsigned int>& x, const std::vector<unsigned int>& y,
+                        size_t offset) {
+    if (x.size() < y.size() + offset) x.resize(y.size() + offset, 0);
+    unsigned long long carry = 0;
+    size_t i = offset;
+    for (size_t j = 0; j < y.size(); ++i, ++j) {
+        carry += (unsigned long long)x[i] + y[j];
+        x[i] = (unsigned int)carry;
+        carry >>= 32;
+    }
+    for (; carry; ++i) {
+        if (i == x.size()) x.push_back(0);
+        carry += x[i];
+        x[i] = (unsigned int)carry;
+        carry >>= 32;
     }
+}
 
-    for (int i = 0; i < z0.size(); ++i) {
-        if (i >= z1.size()) z1.push_back(0);
-        if (z1[i] < z0[i]) {
-            int j = i + 1;
-            while (j < z1.size() && z1[j] == 0) {
-                z1[j] = BASE - 1;
-                j++;
-            }
-            if (j < z1.size()) {
-                z1[j]--;
-                z1[i] += BASE;
+// x -= y, where x >= y
+void subtract_binary(std::vector<unsigned int>& x, const std::vector<unsigned int>& y) {
+    long long borrow = 0;
+    for (size_t i = 0; i < x.size() && (i < y.size() || borrow); ++i) {
+        long long cur = (long long)x[i] - borrow - (i < y.size() ? y[i] : 0);
+        borrow = cur < 0;
+        x[i] = (unsigned int)(cur + (borrow << 32));
+    }
+    trim_binary(x);
+}
+
+std::vector<unsigned int> multiply_binary(const std::vector<unsigned int>& a,
+                                          const std::vector<unsigned int>& b) {
+    if (a.size() < thresholds.karatsuba || b.size() < thresholds.karatsuba) {
+        std::vector<unsigned int> result(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            unsigned long long carry = 0;
+            for (size_t j = 0; j < b.size(); ++j) {
+                carry += (unsigned long long)a[i] * b[j] + result[i + j];
+                result[i + j] = (unsigned int)carry;
+                carry >>= 32;
             }
+            result[i + b.size()] = (unsigned int)carry;
         }
-        z1[i] -= z0[i];
+        trim_binary(result);
+        return result;
     }
 
-    remove_leading_zeros(z1);
+    size_t m = (std::max(a.size(), b.size()) + 1) / 2;
+    std::vector<unsigned int> a_low(a.begin(), a.begin() + std::min(m, a.size()));
+    std::vector<unsigned int> a_high(a.begin() + std::min(m, a.size()), a.end());
+    std::vector<unsigned int> b_low(b.begin(), b.begin() + std::min(m, b.size()));
+    std::vector<unsigned int> b_high(b.begin() + std::min(m, b.size()), b.end());
+
+    std::vector<unsigned int> z0 = multiply_binary(a_low, b_low);
+    std::vector<unsigned int> z2 = multiply_binary(a_high, b_high);
+    add_binary_shifted(a_low, a_high, 0);
+    add_binary_shifted(b_low, b_high, 0);
+    std::vector<unsigned int> z1 = multiply_binary(a_low, b_low);
+    subtract_binary(z1, z2);
+    subtract_binary(z1, z0);
+
+    std::vector<unsigned int> result;
+    result.reserve(a.size() + b.size());
+    result = z0;
+    add_binary_shifted(result, z1, m);
+    add_binary_shifted(result, z2, 2 * m);
+    trim_binary(result);
+    return result;
+}
 
-    // Combine results: z0 + z1 * BASE^m + z2 * BASE^(2*m)
-    std::vector<int> result;
+// Cached powers for radix conversion
+//
+// Splitting n words in half needs 2^(32 * 2^k) in decimal, and splitting n
+// limbs needs BASE^(2^k) in binary. Entry k is squared from entry k - 1 on
+// first use and kept for later conversions until the cache would exceed
+// its byte limit; beyond that powers are computed and dropped. Entries
+// are handed out as shared pointers, so clearing the cache never pulls
+// one from under a running conversion.
+struct power_cache {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<const limb_vector>> decimal;  // 2^(32 * 2^k)
+    std::vector<std::shared_ptr<const std::vector<unsigned int>>> binary;  // BASE^(2^k)
+    size_t bytes = 0;
+    size_t limit = SJTU_POWER_CACHE_LIMIT;
+};
+
+// Function-local so that conversions during static initialization work
+static power_cache& powers() {
+    static power_cache cache;
+    return cache;
+}
 
-    // Start with z0
-    result = z0;
+// Entry k of table, squaring up from first (entry 0) as needed. The
+// squaring runs without the lock, so powers too large to be kept do not
+// serialize the threads that need them.
+template <class T, class Square>
+std::shared_ptr<const T> cached_power(std::vector<std::shared_ptr<const T>>& table, size_t k,
+                                      const T& first, Square square) {
+    power_cache& cache = powers();
+    std::shared_ptr<const T> power;
+    size_t level = 0;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (k < table.size()) return table[k];
+        if (!table.empty()) {
+            power = table.back();
+            level = table.size() - 1;
+        }
+    }
 
-    // Add z1 shifted by m
-    if (!z1.empty()) {
-        if (result.size() < m) result.resize(m, 0);
-        carry = 0;
-        for (int i = 0; i < z1.size() || carry; ++i) {
-            int pos = m + i;
-            if (pos >= result.size()) result.push_back(0);
-            long long sum = result[pos] + carry;
-            if (i < z1.size()) sum += z1[i];
-            result[pos] = sum % BASE;
-            carry = sum / BASE;
+    // Only a prefix of the powers is kept, so entry i is always table[i];
+    // a power another thread has published meanwhile is not added twice
+    auto keep = [&](const std::shared_ptr<const T>& power, size_t level) {
+        size_t bytes = power->size() * sizeof(int);
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (level == table.size() && cache.bytes + bytes <= cache.limit) {
+            cache.bytes += bytes;
+            table.push_back(power);
         }
+    };
+    if (!power) {
+        power = std::make_shared<const T>(first);
+        keep(power, level);
     }
+    while (level < k) {
+        power = std::make_shared<const T>(square(*power));
+        keep(power, ++level);
+    }
+    return power;
+}
 
-    // Add z2 shifted by 2*m
-    if (!z2.empty()) {
-        int shift = 2 * m;
-        if (result.size() < shift) result.resize(shift, 0);
-        carry = 0;
-        for (int i = 0; i < z2.size() || carry; ++i) {
-            int pos = shift + i;
-            if (pos >= result.size()) result.push_back(0);
-            long long sum = result[pos] + carry;
-            if (i < z2.size()) sum += z2[i];
-            result[pos] = sum % BASE;
-            carry = sum / BASE;
+void set_power_cache_limit(size_t bytes) {
+    power_cache& cache = powers();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.limit = bytes;
+    while (cache.bytes > cache.limit) {
+        // Drop the largest entry, the last of either table
+        bool drop_decimal = !cache.decimal.empty() &&
+                            (cache.binary.empty() ||
+                             cache.decimal.back()->size() >= cache.binary.back()->size());
+        if (drop_decimal) {
+            cache.bytes -= cache.decimal.back()->size() * sizeof(int);
+            cache.decimal.pop_back();
+        } else {
+            cache.bytes -= cache.binary.back()->size() * sizeof(int);
+            cache.binary.pop_back();
         }
     }
+}
+
+size_t get_power_cache_limit() {
+    power_cache& cache = powers();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.limit;
+}
 
+size_t power_cache_bytes() {
+    power_cache& cache = powers();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.bytes;
+}
+
+void clear_power_cache() {
+    power_cache& cache = powers();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.decimal.clear();
+    cache.binary.clear();
+    cache.bytes = 0;
+}
+
+// Largest k with 2^k < n, for n >= 2
+static size_t split_level(size_t n) {
+    size_t k = 0;
+    while ((size_t(2) << k) < n) ++k;
+    return k;
+}
+
+// hi * BASE^(2^k) + lo, converting both halves recursively
+std::vector<unsigned int> decimal_to_binary(const limb_vector& num) {
+    if (num.size() <= CONVERT_THRESHOLD) return decimal_to_binary_basecase(num);
+
+    size_t k = split_level(num.size());
+    size_t half = size_t(1) << k;
+    limb_vector low(num.begin(), num.begin() + half);
+    limb_vector high(num.begin() + half, num.end());
+    remove_leading_zeros(low);
+
+    std::shared_ptr<const std::vector<unsigned int>> power = cached_power(
+        powers().binary, k, std::vector<unsigned int>(1, BASE),
+        [](const std::vector<unsigned int>& p) { return multiply_binary(p, p); });
+    std::vector<unsigned int> result = multiply_binary(decimal_to_binary(high), *power);
+    add_binary_shifted(result, decimal_to_binary(low), 0);
+    trim_binary(result);
+    return result;
+}
+
+static limb_vector two_pow_32() {
+    limb_vector power(2, 4);
+    power[0] = 294967296;
+    return power;
+}
+
+// hi * 2^(32 * 2^k) + lo, converting both halves recursively
+limb_vector binary_to_decimal(const std::vector<unsigned int>& bin) {
+    if (bin.size() <= CONVERT_THRESHOLD) return binary_to_decimal_basecase(bin);
+
+    size_t k = split_level(bin.size());
+    size_t half = size_t(1) << k;
+    std::vector<unsigned int> low(bin.begin(), bin.begin() + half);
+    std::vector<unsigned int> high(bin.begin() + half, bin.end());
+    trim_binary(low);
+
+    std::shared_ptr<const limb_vector> power = cached_power(
+        powers().decimal, k, two_pow_32(),
+        [](const limb_vector& p) { return multiply_karatsuba(p, p); });
+    limb_vector result = multiply_karatsuba(binary_to_decimal(high), *power);
+    add_shifted(result, binary_to_decimal(low), 0);
     remove_leading_zeros(result);
     return result;
 }
@@ -190,9 +629,18 @@ int2048::int2048(const std::string& str) {
 
 int2048::int2048(const int2048& other) : sign(other.sign), digits(other.digits) {}
 
+// Moved-from values are left as zero
+int2048::int2048(int2048&& other) noexcept
+    : sign(other.sign), digits(std::move(other.digits)), binary(std::move(other.binary)) {
+    other.sign = true;
+    other.digits.assign(1, 0);
+}
+
 // Basic operations
 void int2048::read(const std::string& str) {
+    SJTU_STAT_SCOPE(STAT_READ, str.size() / BASE_DIGITS + 1);
     digits.clear();
+    binary.reset();
 
     size_t start = 0;
     sign = true;
@@ -234,9 +682,12 @@ void int2048::read(const std::string& str) {
         }
         digits.push_back(val);
     }
+    // Leading zeros longer than a limb leave zero limbs on top
+    remove_leading_zeros(digits);
 }
 
 void int2048::print() {
+    SJTU_STAT_SCOPE(STAT_PRINT, digits.size());
     if (!sign && !(digits.size() == 1 && digits[0] == 0)) {
         std::cout << '-';
     }
@@ -251,58 +702,27 @@ void int2048::print() {
 }
 
 int2048& int2048::add(const int2048& other) {
+    SJTU_STAT_SCOPE(STAT_ADD, std::max(digits.size(), other.digits.size()));
+    binary.reset();
     if (sign == other.sign) {
-        // Same sign, add absolute values
-        std::vector<int> result;
-        int carry = 0;
-        int max_len = std::max(digits.size(), other.digits.size());
-
-        for (int i = 0; i < max_len || carry; ++i) {
-            int sum = carry;
-            if (i < digits.size()) sum += digits[i];
-            if (i < other.digits.size()) sum += other.digits[i];
-
-            result.push_back(sum % BASE);
-            carry = sum / BASE;
-        }
-
-        digits = result;
+        // Same sign, add absolute values in place
+        add_shifted(digits, other.digits, 0);
         return *this;
-    } else {
-        // Different signs, subtract
-        int cmp = compare_abs(digits, other.digits);
-
-        if (cmp == 0) {
-            sign = true;
-            digits.assign(1, 0);
-            return *this;
-        }
-
-        std::vector<int> result;
-        bool result_sign = (cmp > 0) ? sign : other.sign;
-        const std::vector<int>& larger = (cmp > 0) ? digits : other.digits;
-        const std::vector<int>& smaller = (cmp > 0) ? other.digits : digits;
-
-        int borrow = 0;
-        for (int i = 0; i < larger.size(); ++i) {
-            int diff = larger[i] - borrow;
-            if (i < smaller.size()) diff -= smaller[i];
-
-            if (diff < 0) {
-                diff += BASE;
-                borrow = 1;
-            } else {
-                borrow = 0;
-            }
-
-            result.push_back(diff);
-        }
+    }
 
-        remove_leading_zeros(result);
-        sign = result_sign;
-        digits = result;
-        return *this;
+    // Different signs, subtract the smaller magnitude from the larger
+    int cmp = compare_abs(digits, other.digits);
+    if (cmp == 0) {
+        sign = true;
+        digits.assign(1, 0);
+    } else if (cmp > 0) {
+        subtract_abs(digits, other.digits);
+    } else {
+        subtract_abs_from(digits, other.digits);
+        sign = other.sign;
     }
+    release_slack(digits);
+    return *this;
 }
 
 int2048 add(int2048 a, const int2048& b) {
@@ -310,9 +730,20 @@ int2048 add(int2048 a, const int2048& b) {
 }
 
 int2048& int2048::minus(const int2048& other) {
-    int2048 temp(other);
-    temp.sign = !temp.sign;
-    return add(temp);
+    SJTU_STAT_SCOPE(STAT_MINUS, std::max(digits.size(), other.digits.size()));
+    if (&other == this) {
+        sign = true;
+        digits.assign(1, 0);
+        binary.reset();
+        release_slack(digits);
+        return *this;
+    }
+
+    // a - b == -(-a + b), without copying b
+    sign = !sign;
+    add(other);
+    if (!is_zero(digits)) sign = !sign;
+    return *this;
 }
 
 int2048 minus(int2048 a, const int2048& b) {
@@ -336,6 +767,18 @@ int2048& int2048::operator=(const int2048& other) {
     if (this != &other) {
         sign = other.sign;
         digits = other.digits;
+        binary.reset();
+    }
+    return *this;
+}
+
+int2048& int2048::operator=(int2048&& other) noexcept {
+    if (this != &other) {
+        sign = other.sign;
+        digits.swap(other.digits);
+        binary = std::move(other.binary);
+        other.sign = true;
+        other.digits.assign(1, 0);
     }
     return *this;
 }
@@ -358,6 +801,8 @@ int2048 operator-(int2048 a, const int2048& b) {
 
 // Multiplication
 int2048& int2048::operator*=(const int2048& other) {
+    SJTU_STAT_SCOPE(STAT_MULTIPLY, digits.size() + other.digits.size());
+    binary.reset();
     if ((digits.size() == 1 && digits[0] == 0) ||
         (other.digits.size() == 1 && other.digits[0] == 0)) {
         sign = true;
@@ -365,10 +810,10 @@ int2048& int2048::operator*=(const int2048& other) {
         return *this;
     }
 
-    std::vector<int> result = multiply_karatsuba(digits, other.digits);
+    limb_vector result = multiply_karatsuba(digits, other.digits);
 
     sign = sign == other.sign;
-    digits = result;
+    digits.swap(result);
     return *this;
 }
 
@@ -376,6 +821,267 @@ int2048 operator*(int2048 a, const int2048& b) {
     return a *= b;
 }
 
+// Memory
+void int2048::reserve(size_t n) {
+    digits.reserve((n + BASE_DIGITS - 1) / BASE_DIGITS);
+}
+
+void int2048::shrink_to_fit() {
+    digits.shrink_to_fit();
+    if (binary) binary->shrink_to_fit();
+}
+
+size_t int2048::memory_usage() const {
+    size_t bytes = sizeof(int2048) + digits.heap_bytes();
+    if (binary) {
+        bytes += sizeof(std::vector<unsigned int>) + binary->capacity() * sizeof(unsigned int);
+    }
+    return bytes;
+}
+
+// Binary serialization
+static const unsigned char SERIAL_MAGIC[4] = {'I', '2', 'K', 1};
+static const size_t SERIAL_HEADER_BYTES = 16;
+
+bool host_is_little_endian() {
+    const unsigned int one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+void store_le(unsigned char* out, unsigned long long value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+unsigned long long load_le(const unsigned char* in, int bytes) {
+    unsigned long long value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= (unsigned long long)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// Validates the header and limbs of a binary form and returns the limb
+// count; sets negative from the sign byte
+size_t check_serialized(const void* buf, size_t size, bool& negative) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(buf);
+    if (size < SERIAL_HEADER_BYTES || memcmp(bytes, SERIAL_MAGIC, 4) != 0 ||
+        bytes[4] > 1 || bytes[5] || bytes[6] || bytes[7]) {
+        throw std::runtime_error("Invalid int2048 binary header");
+    }
+    unsigned long long count = load_le(bytes + 8, 8);
+    if (count == 0 || count > (size - SERIAL_HEADER_BYTES) / 4) {
+        throw std::runtime_error("Invalid int2048 binary limb count");
+    }
+    negative = bytes[4] == 1;
+
+    const unsigned char* limbs = bytes + SERIAL_HEADER_BYTES;
+    unsigned long long top = load_le(limbs + 4 * (count - 1), 4);
+    if ((count > 1 && top == 0) || (count == 1 && top == 0 && negative)) {
+        throw std::runtime_error("Unnormalized int2048 binary data");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (load_le(limbs + 4 * i, 4) >= (unsigned long long)BASE) {
+            throw std::runtime_error("Invalid int2048 binary limb");
+        }
+    }
+    return count;
+}
+
+size_t int2048::serialized_size() const {
+    return SERIAL_HEADER_BYTES + 4 * digits.size();
+}
+
+size_t int2048::serialize(void* buf, size_t size) const {
+    size_t needed = serialized_size();
+    if (size < needed) return 0;
+
+    unsigned char* bytes = static_cast<unsigned char*>(buf);
+    memcpy(bytes, SERIAL_MAGIC, 4);
+    bytes[4] = sign ? 0 : 1;
+    bytes[5] = bytes[6] = bytes[7] = 0;
+    store_le(bytes + 8, digits.size(), 8);
+
+    unsigned char* limbs = bytes + SERIAL_HEADER_BYTES;
+    if (host_is_little_endian()) {
+        memcpy(limbs, digits.data(), 4 * digits.size());
+    } else {
+        for (size_t i = 0; i < digits.size(); ++i) {
+            store_le(limbs + 4 * i, digits[i], 4);
+        }
+    }
+    return needed;
+}
+
+int2048 int2048::deserialize(const void* buf, size_t size) {
+    bool negative;
+    size_t count = check_serialized(buf, size, negative);
+    const unsigned char* limbs = static_cast<const unsigned char*>(buf) + SERIAL_HEADER_BYTES;
+
+    int2048 result;
+    result.sign = !negative;
+    result.digits.assign(count, 0);
+    if (host_is_little_endian()) {
+        memcpy(result.digits.data(), limbs, 4 * count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            result.digits[i] = load_le(limbs + 4 * i, 4);
+        }
+    }
+    return result;
+}
+
+int2048 int2048::view(const void* buf, size_t size) {
+    // Validate first: the limbs may only be located once size is known to
+    // cover the header
+    bool negative;
+    size_t count = check_serialized(buf, size, negative);
+    const unsigned char* limbs = static_cast<const unsigned char*>(buf) + SERIAL_HEADER_BYTES;
+    if (!host_is_little_endian() || reinterpret_cast<std::uintptr_t>(limbs) % alignof(int) != 0) {
+        return deserialize(buf, size);
+    }
+
+    int2048 result;
+    result.sign = !negative;
+    result.digits.borrow(reinterpret_cast<const int*>(limbs), count);
+    return result;
+}
+
+// Fused multiply-add
+int2048& int2048::mul_accumulate(const int2048& a, const int2048& b, bool negate) {
+    if (is_zero(a.digits) || is_zero(b.digits)) return *this;
+    if (&a == this || &b == this) {
+        int2048 copy(*this);
+        return mul_accumulate(&a == this ? copy : a, &b == this ? copy : b, negate);
+    }
+
+    SJTU_STAT_SCOPE(STAT_FUSED_MULTIPLY_ADD, a.digits.size() + b.digits.size());
+    bool product_sign = (a.sign == b.sign) != negate;
+    if (a.digits.size() >= thresholds.karatsuba && b.digits.size() >= thresholds.karatsuba) {
+        int2048 product(0);
+        product.digits = multiply_karatsuba(a.digits, b.digits);
+        product.sign = product_sign;
+        return add(product);
+    }
+
+    SJTU_STAT_COUNT(STAT_MULTIPLY_SCHOOLBOOK, a.digits.size() + b.digits.size());
+    binary.reset();
+    if (is_zero(digits)) sign = product_sign;
+
+    // Accumulate +-a[i] * b[j] straight into the limbs. A carry out of the
+    // top limb means the magnitude of the product was larger, and the limbs
+    // hold BASE^len - |result|.
+    const limb_vector& x = a.digits;
+    const limb_vector& y = b.digits;
+    bool subtract = sign != product_sign;
+    size_t len = std::max(digits.size(), x.size() + y.size()) + 1;
+    digits.resize(len, 0);
+
+    long long overflow = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        long long carry = 0;
+        size_t k = i;
+        for (size_t j = 0; j < y.size(); ++j, ++k) {
+            long long product = (long long)x[i] * y[j];
+            long long cur = digits[k] + carry + (subtract ? -product : product);
+            carry = cur / BASE;
+            cur %= BASE;
+            if (cur < 0) {
+                cur += BASE;
+                --carry;
+            }
+            digits[k] = cur;
+        }
+        for (; carry && k < len; ++k) {
+            long long cur = digits[k] + carry;
+            carry = cur < 0 ? -1 : cur / BASE;
+            digits[k] = cur - carry * BASE;
+        }
+        overflow += carry;
+    }
+
+    if (overflow < 0) {
+        // Take the complement and flip the sign
+        int borrow = 0;
+        for (size_t k = 0; k < len; ++k) {
+            int diff = -digits[k] - borrow;
+            borrow = diff < 0;
+            digits[k] = borrow ? diff + BASE : diff;
+        }
+        sign = !sign;
+    }
+    remove_leading_zeros(digits);
+    if (is_zero(digits)) sign = true;
+    release_slack(digits);
+    return *this;
+}
+
+int2048& int2048::addmul(const int2048& a, const int2048& b) {
+    return mul_accumulate(a, b, false);
+}
+
+int2048& int2048::submul(const int2048& a, const int2048& b) {
+    return mul_accumulate(a, b, true);
+}
+
+int2048 fma(int2048 acc, const int2048& a, const int2048& b) {
+    return acc.addmul(a, b);
+}
+
+int2048& int2048::assign_sum(const int2048* const* terms, const bool* negate, size_t count) {
+    // Only *this can change under us; remember its length before resizing
+    size_t own_size = digits.size();
+    size_t len = 1;
+    for (size_t t = 0; t < count; ++t) {
+        len = std::max(len, (terms[t] == this ? own_size : terms[t]->digits.size()) + 1);
+    }
+    digits.resize(len, 0);
+
+    // Limb i of every term is read before limb i of *this is written
+    long long carry = 0;
+    for (size_t i = 0; i < len; ++i) {
+        long long cur = carry;
+        for (size_t t = 0; t < count; ++t) {
+            const int2048& term = *terms[t];
+            if (i < (&term == this ? own_size : term.digits.size())) {
+                // Subtract when exactly one of "negative" and "negated" holds
+                cur += term.sign == negate[t] ? -term.digits[i] : term.digits[i];
+            }
+        }
+        carry = cur / BASE;
+        cur %= BASE;
+        if (cur < 0) {
+            cur += BASE;
+            --carry;
+        }
+        digits[i] = cur;
+    }
+    while (carry > 0) {
+        digits.push_back(carry % BASE);
+        carry /= BASE;
+    }
+
+    sign = true;
+    if (carry < 0) {
+        // The limbs hold BASE^len - |sum|
+        int borrow = 0;
+        for (size_t i = 0; i < len; ++i) {
+            int diff = -digits[i] - borrow;
+            borrow = diff < 0;
+            digits[i] = borrow ? diff + BASE : diff;
+        }
+        sign = false;
+    }
+    remove_leading_zeros(digits);
+    if (is_zero(digits)) sign = true;
+    release_slack(digits);
+    binary.reset();
+    return *this;
+}
+
 // Division
 int2048& int2048::operator/=(const int2048& other) {
     *this = *this / other;
@@ -383,6 +1089,7 @@ int2048& int2048::operator/=(const int2048& other) {
 }
 
 int2048 operator/(int2048 a, const int2048& b) {
+    SJTU_STAT_SCOPE(STAT_DIVIDE, a.digits.size() + b.digits.size());
     if (b.digits.size() == 1 && b.digits[0] == 0) {
         throw std::runtime_error("Division by zero");
     }
@@ -390,14 +1097,15 @@ int2048 operator/(int2048 a, const int2048& b) {
     // Handle division by 1 or -1
     if (b.digits.size() == 1 && b.digits[0] == 1) {
         int2048 result(a);
-        result.sign = (a.sign == b.sign);
+        result.sign = (a.sign == b.sign) || is_zero(a.digits);
         return result;
     }
 
     int cmp = compare_abs(a.digits, b.digits);
 
     if (cmp < 0) {
-        return int2048(0);
+        // Floor of a value in (-1, 0) is -1
+        return (a.sign == b.sign || is_zero(a.digits)) ? int2048(0) : int2048(-1);
     }
 
     if (cmp == 0) {
@@ -407,10 +1115,15 @@ int2048 operator/(int2048 a, const int2048& b) {
     }
 
     // Perform long division
-    std::vector<int> quotient;
-    std::vector<int> remainder;
+    limb_vector quotient;
+    limb_vector remainder;
+    limb_vector product;
+    quotient.reserve(a.digits.size());
+    remainder.reserve(b.digits.size() + 2);
+    product.reserve(b.digits.size() + 1);
 
     for (int i = a.digits.size() - 1; i >= 0; --i) {
+        detail::check_cancelled();
         remainder.insert(remainder.begin(), a.digits[i]);
         remove_leading_zeros(remainder);
 
@@ -422,6 +1135,7 @@ int2048 operator/(int2048 a, const int2048& b) {
         }
 
         // Binary search for the current quotient digit
+        SJTU_STAT_COUNT(STAT_DIVIDE_LIMB_SEARCH, b.digits.size());
         int left = 0, right = BASE - 1;
         int best = 0;
 
@@ -429,7 +1143,7 @@ int2048 operator/(int2048 a, const int2048& b) {
             int mid = (left + right) / 2;
 
             // Calculate mid * b
-            std::vector<int> product;
+            product.clear();
             long long carry = 0;
             for (int j = 0; j < b.digits.size() || carry; ++j) {
                 long long val = carry;
@@ -451,7 +1165,7 @@ int2048 operator/(int2048 a, const int2048& b) {
         quotient.push_back(best);
 
         // Update remainder = remainder - best * b
-        std::vector<int> product;
+        product.clear();
         long long carry = 0;
         for (int j = 0; j < b.digits.size() || carry; ++j) {
             long long val = carry;
@@ -484,11 +1198,12 @@ int2048 operator/(int2048 a, const int2048& b) {
     remove_leading_zeros(quotient);
 
     int2048 result(0);
-    result.digits = quotient;
+    release_slack(quotient);
+    result.digits.swap(quotient);
     result.sign = (a.sign == b.sign);
 
     // Handle floor division for cases where rounding toward negative infinity is needed
-    if (!remainder.empty() && compare_abs(remainder, b.digits) != 0) {
+    if (!remainder.empty() && !is_zero(remainder)) {
         // If signs are different and there's a remainder, we need to subtract 1
         if (a.sign != b.sign) {
             result = result - int2048(1);
@@ -504,6 +1219,7 @@ int2048& int2048::operator%=(const int2048& other) {
 }
 
 int2048 operator%(int2048 a, const int2048& b) {
+    SJTU_STAT_SCOPE(STAT_MODULO, a.digits.size() + b.digits.size());
     int2048 quotient = a / b;
     int2048 product = quotient * b;
     int2048 remainder = a - product;
@@ -519,6 +1235,7 @@ std::istream& operator>>(std::istream& is, int2048& num) {
 }
 
 std::ostream& operator<<(std::ostream& os, const int2048& num) {
+    SJTU_STAT_SCOPE(STAT_PRINT, num.digits.size());
     if (!num.sign && !(num.digits.size() == 1 && num.digits[0] == 0)) {
         os << '-';
     }
@@ -535,9 +1252,18 @@ std::ostream& operator<<(std::ostream& os, const int2048& num) {
 }
 
 // Comparison operators
+int compare(const int2048& a, const int2048& b) {
+    if (a.sign != b.sign) return a.sign ? 1 : -1;
+    int cmp = compare_abs(a.digits, b.digits);
+    return a.sign ? cmp : -cmp;
+}
+
 bool operator==(const int2048& a, const int2048& b) {
-    if (a.sign != b.sign) return false;
-    return compare_abs(a.digits, b.digits) == 0;
+    // Normalized values are equal exactly when their limbs are
+    if (a.sign != b.sign || a.digits.size() != b.digits.size()) return false;
+    const int* x = a.digits.data();
+    const int* y = b.digits.data();
+    return x == y || memcmp(x, y, a.digits.size() * sizeof(int)) == 0;
 }
 
 bool operator!=(const int2048& a, const int2048& b) {
@@ -545,28 +1271,284 @@ bool operator!=(const int2048& a, const int2048& b) {
 }
 
 bool operator<(const int2048& a, const int2048& b) {
-    if (a.sign != b.sign) {
-        return a.sign < b.sign;  // true < false, so positive < negative
-    }
-
-    int cmp = compare_abs(a.digits, b.digits);
-    if (a.sign) {  // Both positive
-        return cmp < 0;
-    } else {  // Both negative
-        return cmp > 0;
-    }
+    return compare(a, b) < 0;
 }
 
 bool operator>(const int2048& a, const int2048& b) {
-    return b < a;
+    return compare(a, b) > 0;
 }
 
 bool operator<=(const int2048& a, const int2048& b) {
-    return !(a > b);
+    return compare(a, b) <= 0;
 }
 
 bool operator>=(const int2048& a, const int2048& b) {
-    return !(a < b);
+    return compare(a, b) >= 0;
+}
+
+// Bitwise operations
+const std::vector<unsigned int>& int2048::binary_view() const {
+    std::vector<unsigned int>* form = binary.get();
+    if (!form) {
+        // Concurrent readers may both convert; one of them publishes
+        form = binary.publish(std::unique_ptr<std::vector<unsigned int>>(
+            new std::vector<unsigned int>(decimal_to_binary(digits))));
+    }
+    return *form;
+}
+
+// Sets the value from a base 2^32 magnitude, keeping it as the binary view
+void int2048::assign_binary(std::vector<unsigned int>& magnitude, bool negative) {
+    trim_binary(magnitude);
+    digits = binary_to_decimal(magnitude);
+    sign = !negative || is_zero(digits);
+    binary.reset(new std::vector<unsigned int>());
+    binary->swap(magnitude);
+}
+
+int2048 int2048::operator~() const {
+    // ~x == -(x + 1)
+    int2048 result(*this);
+    result.add(int2048(1));
+    return -result;
+}
+
+int2048& int2048::operator<<=(long long k) {
+    // -LLONG_MIN overflows, but no value has LLONG_MAX bits, so shifting
+    // right by LLONG_MAX instead gives the same result
+    if (k < 0) return *this >>= k == LLONG_MIN ? LLONG_MAX : -k;
+    if (k == 0 || is_zero(digits)) return *this;
+
+    // Each decimal pass costs O(n); fall back to the binary view once the
+    // number of passes grows past the length of the number.
+    if (!binary && shift_in_decimal(k, digits.size())) {
+        SJTU_STAT_SCOPE(STAT_SHIFT_DECIMAL, digits.size());
+        for (; k > 0; k -= SHIFT_STEP) {
+            multiply_small(digits, 1 << std::min<long long>(k, SHIFT_STEP));
+        }
+        return *this;
+    }
+
+    SJTU_STAT_SCOPE(STAT_SHIFT_BINARY, digits.size());
+    std::vector<unsigned int> result = shift_binary_left(binary_view(), k);
+    assign_binary(result, !sign);
+    return *this;
+}
+
+int2048 operator<<(int2048 a, long long k) {
+    return a <<= k;
+}
+
+int2048& int2048::operator>>=(long long k) {
+    // As in <<=; a non-zero value shifted left by LLONG_MIN bits does not
+    // fit in memory either way
+    if (k < 0) return *this <<= k == LLONG_MIN ? LLONG_MAX : -k;
+    if (k == 0 || is_zero(digits)) return *this;
+
+    // Rounding toward negative infinity: -(ceil(|x| / 2^k)) for negatives
+    bool inexact = false;
+    if (!binary && shift_in_decimal(k, digits.size())) {
+        SJTU_STAT_SCOPE(STAT_SHIFT_DECIMAL, digits.size());
+        for (; k > 0 && !is_zero(digits); k -= SHIFT_STEP) {
+            if (divide_small(digits, 1 << std::min<long long>(k, SHIFT_STEP))) {
+                inexact = true;
+            }
+        }
+        if (!sign && inexact) {
+            increment_abs(digits);
+        }
+        if (is_zero(digits)) sign = true;
+        release_slack(digits);
+        return *this;
+    }
+
+    SJTU_STAT_SCOPE(STAT_SHIFT_BINARY, digits.size());
+    std::vector<unsigned int> result = shift_binary_right(binary_view(), k, inexact);
+    if (!sign && inexact) {
+        result.push_back(0);
+        for (size_t i = 0; i < result.size() && ++result[i] == 0; ++i) {
+        }
+    }
+    assign_binary(result, !sign);
+    return *this;
+}
+
+int2048 operator>>(int2048 a, long long k) {
+    return a >>= k;
+}
+
+int2048& int2048::operator&=(const int2048& other) {
+    SJTU_STAT_SCOPE(STAT_BITWISE, std::max(digits.size(), other.digits.size()));
+    bool negative;
+    std::vector<unsigned int> result =
+        bitwise_kernel(binary_view(), !sign, other.binary_view(), !other.sign,
+                       [](unsigned int x, unsigned int y) { return x & y; }, negative);
+    assign_binary(result, negative);
+    return *this;
+}
+
+int2048 operator&(int2048 a, const int2048& b) {
+    return a &= b;
+}
+
+int2048& int2048::operator|=(const int2048& other) {
+    SJTU_STAT_SCOPE(STAT_BITWISE, std::max(digits.size(), other.digits.size()));
+    bool negative;
+    std::vector<unsigned int> result =
+        bitwise_kernel(binary_view(), !sign, other.binary_view(), !other.sign,
+                       [](unsigned int x, unsigned int y) { return x | y; }, negative);
+    assign_binary(result, negative);
+    return *this;
+}
+
+int2048 operator|(int2048 a, const int2048& b) {
+    return a |= b;
+}
+
+int2048& int2048::operator^=(const int2048& other) {
+    SJTU_STAT_SCOPE(STAT_BITWISE, std::max(digits.size(), other.digits.size()));
+    bool negative;
+    std::vector<unsigned int> result =
+        bitwise_kernel(binary_view(), !sign, other.binary_view(), !other.sign,
+                       [](unsigned int x, unsigned int y) { return x ^ y; }, negative);
+    assign_binary(result, negative);
+    return *this;
+}
+
+int2048 operator^(int2048 a, const int2048& b) {
+    return a ^= b;
+}
+
+long long int2048::bit_length() const {
+    const std::vector<unsigned int>& bin = binary_view();
+    unsigned int top = bin.back();
+    long long bits = 32LL * (bin.size() - 1);
+    while (top) {
+        ++bits;
+        top >>= 1;
+    }
+    return bits;
+}
+
+long long int2048::popcount() const {
+    long long count = 0;
+    for (unsigned int word : binary_view()) {
+        count += __builtin_popcount(word);
+    }
+    return count;
+}
+
+// Decimal shifts
+int2048& int2048::mul_pow10(long long k) {
+    // -LLONG_MIN overflows, but no value has LLONG_MAX digits, so dividing
+    // by 10^LLONG_MAX instead gives the same result
+    if (k < 0) return div_pow10(k == LLONG_MIN ? LLONG_MAX : -k);
+    if (k == 0 || is_zero(digits)) return *this;
+
+    SJTU_STAT_SCOPE(STAT_SHIFT10, digits.size());
+    // Whole limbs move by k / 9, the rest is one scalar pass by 10^(k % 9)
+    size_t limbs = k / BASE_DIGITS;
+    long long factor = POW10[k % BASE_DIGITS];
+    limb_vector result(digits.size() + limbs + 1, 0);
+    long long carry = 0;
+    for (size_t i = 0; i < digits.size(); ++i) {
+        long long cur = digits[i] * factor + carry;
+        result[i + limbs] = cur % BASE;
+        carry = cur / BASE;
+    }
+    result.back() = carry;
+    remove_leading_zeros(result);
+
+    digits.swap(result);
+    binary.reset();
+    return *this;
+}
+
+int2048& int2048::div_pow10(long long k) {
+    // As in mul_pow10; a non-zero value times 10^-LLONG_MIN does not fit
+    // in memory either way
+    if (k < 0) return mul_pow10(k == LLONG_MIN ? LLONG_MAX : -k);
+    if (k == 0 || is_zero(digits)) return *this;
+
+    SJTU_STAT_SCOPE(STAT_SHIFT10, digits.size());
+    size_t limbs = k / BASE_DIGITS;
+    int low = k % BASE_DIGITS;
+    bool inexact = false;
+    for (size_t i = 0; i < limbs && i < digits.size(); ++i) {
+        if (digits[i]) inexact = true;
+    }
+
+    limb_vector result;
+    if (limbs < digits.size()) {
+        // Each output limb takes the high part of digits[i + limbs] and the
+        // low part of the limb above it
+        int divisor = POW10[low];
+        int scale = POW10[BASE_DIGITS - low];
+        if (digits[limbs] % divisor) inexact = true;
+
+        result.reserve(digits.size() - limbs + 1);
+        for (size_t i = limbs; i < digits.size(); ++i) {
+            long long cur = digits[i] / divisor;
+            if (low && i + 1 < digits.size()) {
+                cur += (long long)(digits[i + 1] % divisor) * scale;
+            }
+            result.push_back(cur);
+        }
+        remove_leading_zeros(result);
+    } else {
+        result.assign(1, 0);
+    }
+
+    if (!sign && inexact) {
+        increment_abs(result);
+    }
+    digits.swap(result);
+    if (is_zero(digits)) sign = true;
+    binary.reset();
+    return *this;
+}
+
+int2048& int2048::shift10(long long k) {
+    return k >= 0 ? mul_pow10(k) : div_pow10(k == LLONG_MIN ? LLONG_MAX : -k);
+}
+
+// Hashing
+static const unsigned long long HASH_MULTIPLIERS[4] = {
+    0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL};
+
+static unsigned long long hash_finish(unsigned long long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    return x ^ (x >> 33);
+}
+
+size_t int2048::hash() const noexcept {
+    // Four independent lanes of two limbs each, so the multiplies of one
+    // round overlap; equal values have equal limbs since they are normalized
+    const int* p = digits.data();
+    size_t n = digits.size();
+    unsigned long long lanes[4] = {n, ~(unsigned long long)n, sign, 0};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int l = 0; l < 4; ++l) {
+            unsigned long long word;
+            memcpy(&word, p + i + 2 * l, sizeof(word));
+            lanes[l] = (lanes[l] ^ word) * HASH_MULTIPLIERS[l];
+            lanes[l] ^= lanes[l] >> 29;
+        }
+    }
+    for (int l = 0; i < n; ++i, l = (l + 1) % 4) {
+        lanes[l] = (lanes[l] ^ (unsigned int)p[i]) * HASH_MULTIPLIERS[l];
+        lanes[l] ^= lanes[l] >> 29;
+    }
+
+    unsigned long long h = sign ? 0 : HASH_MULTIPLIERS[0];
+    for (int l = 0; l < 4; ++l) {
+        h = (h ^ hash_finish(lanes[l])) * HASH_MULTIPLIERS[3];
+    }
+    return hash_finish(h);
 }
 
 } // namespace sjtu
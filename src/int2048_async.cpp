@@ -0,0 +1,41 @@
+#include "include/int2048_async.h"
+#include "include/thread_pool.h"
+#include <utility>
+
+namespace sjtu {
+
+// Queues op on the library pool with token checked on its thread
+template <class Op>
+static std::future<int2048> run_async(const cancel_token& token, Op op) {
+    std::shared_ptr<std::packaged_task<int2048()>> task =
+        std::make_shared<std::packaged_task<int2048()>>([token, op]() {
+            detail::cancel_scope scope(token);
+            detail::check_cancelled();
+            return op();
+        });
+    std::future<int2048> result = task->get_future();
+    library_pool().submit([task] { (*task)(); });
+    return result;
+}
+
+std::future<int2048> async_multiply(int2048 a, int2048 b, cancel_token token) {
+    return run_async(token, [a, b]() { return a * b; });
+}
+
+std::future<int2048> async_divide(int2048 a, int2048 b, cancel_token token) {
+    return run_async(token, [a, b]() { return a / b; });
+}
+
+std::future<int2048> async_pow(int2048 base, unsigned long long exponent, cancel_token token) {
+    return run_async(token, [base, exponent]() {
+        int2048 result(1), square(base);
+        for (unsigned long long e = exponent; e; e >>= 1) {
+            detail::check_cancelled();
+            if (e & 1) result *= square;
+            if (e > 1) square *= square;
+        }
+        return result;
+    });
+}
+
+} // namespace sjtu
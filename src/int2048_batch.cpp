@@ -0,0 +1,109 @@
+#include "include/int2048.h"
+#include "include/thread_pool.h"
+#include <algorithm>
+#include <vector>
+
+namespace sjtu {
+
+// Limbs of work below which a range is not worth handing to another thread
+static const size_t MIN_LIMBS_PER_TASK = 1 << 14;
+
+// Elements per range for about MIN_LIMBS_PER_TASK limbs of work each, given
+// the total work of all n elements
+static size_t grain_for(size_t n, size_t work) {
+    return std::max<size_t>(1, MIN_LIMBS_PER_TASK * n / std::max<size_t>(work, 1));
+}
+
+// Ranges for n elements: a few per thread, as in thread_pool::parallel_for
+static size_t range_count(size_t n, size_t grain, const thread_pool& pool) {
+    return std::max<size_t>(1, std::min(n / grain, 4 * (size_t)(pool.size() + 1)));
+}
+
+void int2048::multiply_many(const int2048* a, const int2048* b, int2048* out, size_t n) {
+    // Schoolbook cost, which overstates Karatsuba and so only shrinks ranges
+    size_t work = 0;
+    for (size_t i = 0; i < n; ++i) {
+        work += a[i].digits.size() * b[i].digits.size();
+    }
+    library_pool().parallel_for(n, grain_for(n, work), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            out[i] = a[i] * b[i];
+        }
+    });
+}
+
+// values[first] + ... + values[last - 1], accumulated in place
+static int2048 sum_range(const int2048* values, size_t first, size_t last) {
+    int2048 total;
+    for (size_t i = first; i < last; ++i) {
+        total += values[i];
+    }
+    return total;
+}
+
+int2048 int2048::sum(const int2048* values, size_t n) {
+    size_t work = 0;
+    for (size_t i = 0; i < n; ++i) {
+        work += values[i].digits.size();
+    }
+    thread_pool& pool = library_pool();
+    size_t grain = grain_for(n, work);
+    size_t ranges = range_count(n, grain, pool);
+    if (ranges == 1) return sum_range(values, 0, n);
+
+    // One partial sum per range, then pairs of partials until one is left
+    std::vector<int2048> partials(ranges);
+    pool.parallel_for(ranges, 1, [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; ++r) {
+            partials[r] = sum_range(values, n * r / ranges, n * (r + 1) / ranges);
+        }
+    });
+    while (partials.size() > 1) {
+        size_t pairs = partials.size() / 2;
+        pool.parallel_for(pairs, 1, [&](size_t first, size_t last) {
+            for (size_t j = first; j < last; ++j) {
+                partials[2 * j] += partials[2 * j + 1];
+            }
+        });
+        for (size_t j = 0; j < (partials.size() + 1) / 2; ++j) {
+            partials[j] = std::move(partials[2 * j]);
+        }
+        partials.resize((partials.size() + 1) / 2);
+    }
+    return std::move(partials[0]);
+}
+
+void int2048::prefix_sum(const int2048* values, int2048* out, size_t n) {
+    size_t work = 0;
+    for (size_t i = 0; i < n; ++i) {
+        work += values[i].digits.size();
+    }
+    thread_pool& pool = library_pool();
+    // Every element is added twice when split, once for its range's total
+    // and once for its own prefix
+    size_t ranges = range_count(n, grain_for(n, 2 * work), pool);
+
+    std::vector<int2048> offsets(ranges);
+    if (ranges > 1) {
+        pool.parallel_for(ranges - 1, 1, [&](size_t first, size_t last) {
+            for (size_t r = first; r < last; ++r) {
+                offsets[r + 1] = sum_range(values, n * r / ranges, n * (r + 1) / ranges);
+            }
+        });
+        for (size_t r = 1; r < ranges; ++r) {
+            offsets[r] += offsets[r - 1];
+        }
+    }
+
+    pool.parallel_for(ranges, 1, [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; ++r) {
+            int2048 running = std::move(offsets[r]);
+            for (size_t i = n * r / ranges; i < n * (r + 1) / ranges; ++i) {
+                running += values[i];
+                out[i] = running;
+            }
+        }
+    });
+}
+
+} // namespace sjtu
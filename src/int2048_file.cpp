@@ -0,0 +1,217 @@
+#include "include/int2048.h"
+#include "include/int2048_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SJTU_INT2048_MMAP 1
+#endif
+
+namespace sjtu {
+
+// Matches the limb layout in int2048.cpp
+static const int BASE_DIGITS = 9;
+// Smallest number of limbs worth handing to a thread of its own
+static const size_t MIN_LIMBS_PER_THREAD = 1 << 16;
+
+// Read-only or read-write mapping of a whole file, unmapped on scope exit
+class mapped_file {
+public:
+    mapped_file(const std::string& path, size_t write_size);
+    ~mapped_file();
+
+    char* data() { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    int fd_;
+    char* data_;
+    size_t size_;
+    std::string owned_;  // contents when mmap is unavailable
+    std::string path_;
+    bool writing_;
+};
+
+#ifdef SJTU_INT2048_MMAP
+
+// write_size == 0 maps an existing file for reading; otherwise the file is
+// created or truncated to write_size bytes and mapped for writing
+mapped_file::mapped_file(const std::string& path, size_t write_size)
+    : fd_(-1), data_(nullptr), size_(0), path_(path), writing_(write_size > 0) {
+    fd_ = writing_ ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                   : open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    if (writing_) {
+        if (ftruncate(fd_, write_size) != 0) {
+            close(fd_);
+            throw std::runtime_error("Cannot resize " + path);
+        }
+        size_ = write_size;
+    } else {
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            close(fd_);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        size_ = st.st_size;
+    }
+    if (size_ == 0) return;
+
+    void* p = mmap(nullptr, size_, writing_ ? PROT_READ | PROT_WRITE : PROT_READ,
+                   MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        close(fd_);
+        throw std::runtime_error("Cannot map " + path);
+    }
+    madvise(p, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<char*>(p);
+}
+
+mapped_file::~mapped_file() {
+    if (data_) munmap(data_, size_);
+    if (fd_ >= 0) close(fd_);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& path, size_t write_size)
+    : fd_(-1), data_(nullptr), size_(0), path_(path), writing_(write_size > 0) {
+    if (writing_) {
+        owned_.assign(write_size, '\0');
+    } else {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        owned_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    data_ = &owned_[0];
+    size_ = owned_.size();
+}
+
+mapped_file::~mapped_file() {
+    if (writing_) {
+        std::ofstream out(path_, std::ios::binary);
+        out.write(owned_.data(), owned_.size());
+    }
+}
+
+#endif
+
+// Runs body(first, last) over [0, count) split into contiguous ranges
+template <class Body>
+static void for_each_range(size_t count, unsigned threads, Body body) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, std::max<size_t>(1, count / MIN_LIMBS_PER_THREAD));
+    if (threads <= 1) {
+        body(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    size_t step = (count + threads - 1) / threads;
+    for (size_t first = step; first < count; first += step) {
+        workers.emplace_back(body, first, std::min(count, first + step));
+    }
+    body(0, std::min(count, step));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+int2048 int2048::from_file(const std::string& path, unsigned threads) {
+    mapped_file file(path, 0);
+    SJTU_STAT_SCOPE(STAT_FILE_READ, file.size() / BASE_DIGITS + 1);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    while (begin < end && is_space(*begin)) ++begin;
+    while (end > begin && is_space(end[-1])) --end;
+
+    int2048 result;
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        result.sign = *begin == '+';
+        ++begin;
+    }
+    while (end - begin > 1 && *begin == '0') ++begin;
+    if (begin == end) {
+        throw std::runtime_error("No digits in " + path);
+    }
+
+    // Limb i holds the 9 characters ending BASE_DIGITS * i before the end
+    size_t length = end - begin;
+    size_t count = (length + BASE_DIGITS - 1) / BASE_DIGITS;
+    result.digits.assign(count, 0);
+    int* limbs = result.digits.data();
+    std::atomic<bool> valid(true);
+
+    for_each_range(count, threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            size_t stop = length - BASE_DIGITS * i;
+            size_t start = stop > (size_t)BASE_DIGITS ? stop - BASE_DIGITS : 0;
+            int value = 0;
+            for (size_t j = start; j < stop; ++j) {
+                unsigned int d = begin[j] - '0';
+                if (d > 9) {
+                    valid = false;
+                    return;
+                }
+                value = value * 10 + d;
+            }
+            limbs[i] = value;
+        }
+    });
+
+    if (!valid) {
+        throw std::runtime_error("Invalid digit in " + path);
+    }
+    if (result.digits.size() == 1 && result.digits[0] == 0) {
+        result.sign = true;
+    }
+    return result;
+}
+
+void int2048::to_file(const std::string& path, unsigned threads) const {
+    SJTU_STAT_SCOPE(STAT_FILE_WRITE, digits.size());
+    char top[BASE_DIGITS + 1];
+    int top_length = snprintf(top, sizeof(top), "%d", digits.back());
+    bool negative = !sign && !(digits.size() == 1 && digits[0] == 0);
+    size_t count = digits.size();
+    size_t length = negative + top_length + BASE_DIGITS * (count - 1);
+
+    mapped_file file(path, length);
+    char* out = file.data();
+    if (negative) *out++ = '-';
+    memcpy(out, top, top_length);
+    out += top_length;
+
+    // Limb count - 2 - i is written at out + BASE_DIGITS * i
+    const int* limbs = digits.data();
+    for_each_range(count - 1, threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            int value = limbs[count - 2 - i];
+            char* p = out + BASE_DIGITS * (i + 1);
+            for (int j = 0; j < BASE_DIGITS; ++j) {
+                *--p = '0' + value % 10;
+                value /= 10;
+            }
+        }
+    });
+}
+
+} // namespace sjtu
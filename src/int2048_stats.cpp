@@ -0,0 +1,188 @@
+#include "include/int2048_stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+
+namespace sjtu {
+
+static const char* const STAT_NAMES[STAT_COUNT] = {
+    "read",
+    "print",
+    "add",
+    "minus",
+    "multiply",
+    "multiply.schoolbook",
+    "multiply.karatsuba",
+    "divide",
+    "divide.limb_search",
+    "modulo",
+    "fused_multiply_add",
+    "shift.decimal",
+    "shift.binary",
+    "bitwise",
+    "shift10",
+    "file.read",
+    "file.write",
+    "allocate",
+};
+
+// Relaxed atomics: counters may be bumped from several threads at once
+struct stat_counter {
+    std::atomic<unsigned long long> calls;
+    std::atomic<unsigned long long> limbs;
+    std::atomic<unsigned long long> nanoseconds;
+    std::atomic<std::size_t> peak_bytes;
+};
+
+static stat_counter counters[STAT_COUNT];
+
+static std::atomic<std::size_t> live_bytes(0);
+static std::atomic<std::size_t> peak_bytes(0);
+static std::atomic<std::size_t> memory_budget(0);
+
+// The outermost operation running on this thread, and the most bytes held
+// since it started
+static thread_local int scope_depth = 0;
+static thread_local stat_id scope_operation = STAT_COUNT;
+static thread_local std::size_t scope_peak = 0;
+
+static void raise_to(std::atomic<std::size_t>& target, std::size_t value) {
+    std::size_t current = target.load(std::memory_order_relaxed);
+    while (current < value &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+static unsigned long long stat_clock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool stats_enabled() {
+#if defined(SJTU_INT2048_INSTRUMENT) || defined(SJTU_INT2048_TRACK_MEMORY)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool memory_tracking_enabled() {
+#ifdef SJTU_INT2048_TRACK_MEMORY
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<operation_stats> get_stats() {
+    std::vector<operation_stats> result(STAT_COUNT);
+    for (int i = 0; i < STAT_COUNT; ++i) {
+        result[i].name = STAT_NAMES[i];
+        result[i].calls = counters[i].calls.load(std::memory_order_relaxed);
+        result[i].limbs = counters[i].limbs.load(std::memory_order_relaxed);
+        result[i].nanoseconds = counters[i].nanoseconds.load(std::memory_order_relaxed);
+        result[i].peak_bytes = counters[i].peak_bytes.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void reset_stats() {
+    for (stat_counter& counter : counters) {
+        counter.calls.store(0, std::memory_order_relaxed);
+        counter.limbs.store(0, std::memory_order_relaxed);
+        counter.nanoseconds.store(0, std::memory_order_relaxed);
+        counter.peak_bytes.store(0, std::memory_order_relaxed);
+    }
+    peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void dump_stats(std::ostream& os) {
+    if (!stats_enabled()) {
+        os << "int2048 statistics are off; build with -DSJTU_INT2048_INSTRUMENT\n";
+        return;
+    }
+    bool memory = memory_tracking_enabled();
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-22s %12s %16s %12s%s\n", "operation", "calls", "limbs",
+                  "ms", memory ? "    peak KiB" : "");
+    os << line;
+    for (const operation_stats& stats : get_stats()) {
+        if (stats.calls == 0) continue;
+        std::snprintf(line, sizeof(line), "%-22s %12llu %16llu %12.3f", stats.name, stats.calls,
+                      stats.limbs, stats.nanoseconds / 1e6);
+        os << line;
+        if (memory) {
+            std::snprintf(line, sizeof(line), " %11.1f", stats.peak_bytes / 1024.0);
+            os << line;
+        }
+        os << '\n';
+    }
+    if (memory) {
+        memory_stats totals = get_memory_stats();
+        std::snprintf(line, sizeof(line), "limb buffers: %zu bytes live, %zu bytes peak\n",
+                      totals.live_bytes, totals.peak_bytes);
+        os << line;
+    }
+}
+
+memory_stats get_memory_stats() {
+    memory_stats result;
+    result.live_bytes = live_bytes.load(std::memory_order_relaxed);
+    result.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+void set_memory_budget(std::size_t bytes) {
+    memory_budget.store(bytes, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void record_stat(stat_id id, std::size_t limbs, unsigned long long nanoseconds) {
+    counters[id].calls.fetch_add(1, std::memory_order_relaxed);
+    counters[id].limbs.fetch_add(limbs, std::memory_order_relaxed);
+    counters[id].nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void record_allocation(std::size_t bytes) {
+    std::size_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    raise_to(peak_bytes, live);
+    if (scope_depth > 0 && live > scope_peak) scope_peak = live;
+
+    std::size_t budget = memory_budget.load(std::memory_order_relaxed);
+    if (budget && live > budget) {
+        std::fprintf(stderr,
+                     "int2048: limb buffers need %zu bytes, over the budget of %zu bytes "
+                     "(allocating %zu bytes in %s)\n",
+                     live, budget, bytes,
+                     scope_operation < STAT_COUNT ? STAT_NAMES[scope_operation] : "no operation");
+        std::abort();
+    }
+}
+
+void record_release(std::size_t bytes) {
+    live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+stat_scope::stat_scope(stat_id id, std::size_t limbs) : id_(id), limbs_(limbs), peak_start_(0) {
+    if (scope_depth++ == 0) {
+        scope_operation = id;
+        scope_peak = live_bytes.load(std::memory_order_relaxed);
+        peak_start_ = scope_peak;
+    }
+    start_ = stat_clock();
+}
+
+stat_scope::~stat_scope() {
+    record_stat(id_, limbs_, stat_clock() - start_);
+    if (--scope_depth == 0) {
+        raise_to(counters[id_].peak_bytes, scope_peak - peak_start_);
+        scope_operation = STAT_COUNT;
+    }
+}
+
+} // namespace detail
+} // namespace sjtu
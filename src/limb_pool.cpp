@@ -0,0 +1,101 @@
+#include "include/limb_pool.h"
+#include <new>
+
+namespace sjtu {
+
+// Size classes are 2^MIN_SHIFT .. 2^MAX_SHIFT bytes
+static const int MIN_SHIFT = 5;
+static const int MAX_SHIFT = 20;
+static const int CLASS_COUNT = MAX_SHIFT - MIN_SHIFT + 1;
+// Upper bound on the bytes kept in any one free list
+static const std::size_t MAX_CACHED_PER_CLASS = std::size_t(4) << 20;
+
+struct free_block {
+    free_block *next;
+};
+
+// Set once this thread's cache is destroyed. Being trivially destructible
+// it stays readable afterwards, unlike the cache itself, so buffers freed
+// by later thread_local destructors can bypass the cache.
+static thread_local bool cache_destroyed = false;
+
+struct thread_cache {
+    free_block *head[CLASS_COUNT];
+    std::size_t cached[CLASS_COUNT];
+
+    thread_cache() : head(), cached() {}
+    ~thread_cache() {
+        release();
+        cache_destroyed = true;
+    }
+
+    void release() {
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            while (head[c]) {
+                free_block *block = head[c];
+                head[c] = block->next;
+                ::operator delete(block);
+            }
+            cached[c] = 0;
+        }
+    }
+};
+
+static thread_local thread_cache cache;
+
+static int size_class(std::size_t bytes) {
+    int shift = MIN_SHIFT;
+    while ((std::size_t(1) << shift) < bytes) ++shift;
+    return shift - MIN_SHIFT;
+}
+
+static void *pool_allocate(std::size_t bytes) {
+    if (bytes > (std::size_t(1) << MAX_SHIFT) || cache_destroyed) {
+        return ::operator new(bytes);
+    }
+    int c = size_class(bytes);
+    std::size_t class_bytes = std::size_t(1) << (c + MIN_SHIFT);
+    if (free_block *block = cache.head[c]) {
+        cache.head[c] = block->next;
+        cache.cached[c] -= class_bytes;
+        return block;
+    }
+    return ::operator new(class_bytes);
+}
+
+static void pool_deallocate(void *p, std::size_t bytes) {
+    if (bytes > (std::size_t(1) << MAX_SHIFT) || cache_destroyed) {
+        ::operator delete(p);
+        return;
+    }
+    int c = size_class(bytes);
+    std::size_t class_bytes = std::size_t(1) << (c + MIN_SHIFT);
+    if (cache.cached[c] + class_bytes > MAX_CACHED_PER_CLASS) {
+        ::operator delete(p);
+        return;
+    }
+    free_block *block = static_cast<free_block *>(p);
+    block->next = cache.head[c];
+    cache.head[c] = block;
+    cache.cached[c] += class_bytes;
+}
+
+limb_allocator limb_pool_allocator() {
+    limb_allocator allocator = {pool_allocate, pool_deallocate};
+    return allocator;
+}
+
+void release_limb_pool() {
+    if (!cache_destroyed) cache.release();
+}
+
+std::size_t limb_pool_cached_bytes() {
+    std::size_t total = 0;
+    if (cache_destroyed) return 0;
+    for (int c = 0; c < CLASS_COUNT; ++c) {
+        total += cache.cached[c];
+    }
+    return total;
+}
+
+} // namespace sjtu
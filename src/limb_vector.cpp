@@ -0,0 +1,204 @@
+#include "include/limb_vector.h"
+#include "include/int2048_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace sjtu {
+
+static void *default_allocate(std::size_t bytes) {
+    return ::operator new(bytes);
+}
+
+static void default_deallocate(void *p, std::size_t) {
+    ::operator delete(p);
+}
+
+static const limb_allocator default_allocator = {default_allocate, default_deallocate};
+// Points into installed_allocators() once set_limb_allocator() has run
+static std::atomic<const limb_allocator *> current_allocator(&default_allocator);
+static std::size_t share_threshold = 512;
+
+// Every allocator ever installed, kept so that references returned by
+// get_limb_allocator() stay valid
+static std::deque<limb_allocator> &installed_allocators() {
+    static std::deque<limb_allocator> allocators;
+    return allocators;
+}
+
+void set_limb_allocator(const limb_allocator &allocator) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::deque<limb_allocator> &allocators = installed_allocators();
+    const limb_allocator *installed = nullptr;
+    for (const limb_allocator &a : allocators) {
+        if (a.allocate == allocator.allocate && a.deallocate == allocator.deallocate) {
+            installed = &a;
+        }
+    }
+    if (!installed) {
+        allocators.push_back(allocator);
+        installed = &allocators.back();
+    }
+    current_allocator.store(installed, std::memory_order_release);
+}
+
+const limb_allocator &get_limb_allocator() {
+    return *current_allocator.load(std::memory_order_acquire);
+}
+
+void set_share_threshold(std::size_t limbs) {
+    share_threshold = limbs;
+}
+
+std::size_t get_share_threshold() {
+    return share_threshold;
+}
+
+// Every heap buffer starts with its reference count and the deallocate
+// hook of the allocator that made it, so it is freed through that one
+// whatever is installed by then; the limbs follow HEADER_BYTES later
+struct buffer_header {
+    std::atomic<unsigned int> refs;
+    void (*deallocate)(void *p, std::size_t bytes);
+};
+static const std::size_t HEADER_BYTES = 16;
+static_assert(sizeof(buffer_header) <= HEADER_BYTES, "limb buffer header too large");
+
+static buffer_header *header_of(int *limbs) {
+    return reinterpret_cast<buffer_header *>(reinterpret_cast<char *>(limbs) - HEADER_BYTES);
+}
+
+int *limb_vector::allocate(size_type n) {
+    SJTU_STAT_COUNT(STAT_ALLOCATE, n);
+    const limb_allocator &allocator = get_limb_allocator();
+    void *raw = allocator.allocate(HEADER_BYTES + n * sizeof(int));
+    // Counted once it succeeded, so a throwing allocator leaves no phantom bytes
+    SJTU_MEMORY_ALLOCATE(HEADER_BYTES + n * sizeof(int));
+    new (raw) buffer_header{{1}, allocator.deallocate};
+    return reinterpret_cast<int *>(static_cast<char *>(raw) + HEADER_BYTES);
+}
+
+void limb_vector::release(int *p, size_type n) {
+    buffer_header *header = header_of(p);
+    if (header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        void (*deallocate)(void *, std::size_t) = header->deallocate;
+        header->~buffer_header();
+        deallocate(header, HEADER_BYTES + n * sizeof(int));
+        SJTU_MEMORY_RELEASE(HEADER_BYTES + n * sizeof(int));
+    }
+}
+
+void limb_vector::share(const limb_vector &other) {
+    if (!other.heap_.borrowed) {
+        header_of(other.heap_.limbs)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    heap_.limbs = other.heap_.limbs;
+    heap_.borrowed = other.heap_.borrowed;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    __atomic_store_n(&heap_.shared, true, __ATOMIC_RELAXED);
+    __atomic_store_n(&other.heap_.shared, true, __ATOMIC_RELAXED);
+}
+
+void limb_vector::unshare() {
+    // Acquire pairs with the release in the other owner's release(), so its
+    // last reads happen before our writes
+    if (heap_.borrowed || header_of(heap_.limbs)->refs.load(std::memory_order_acquire) != 1) {
+        int *p = allocate(capacity_);
+        std::memcpy(p, heap_.limbs, size_ * sizeof(int));
+        if (!heap_.borrowed) release(heap_.limbs, capacity_);
+        heap_.limbs = p;
+        heap_.borrowed = false;
+    }
+    __atomic_store_n(&heap_.shared, false, __ATOMIC_RELAXED);
+}
+
+void limb_vector::reset() {
+    if (!is_inline() && !heap_.borrowed) release(heap_.limbs, capacity_);
+    size_ = 0;
+    capacity_ = INLINE_CAPACITY;
+}
+
+static void check_length(limb_vector::size_type n) {
+    if (n > limb_vector::max_size()) throw std::length_error("limb_vector: too many limbs");
+}
+
+void limb_vector::reallocate(size_type new_capacity) {
+    check_length(new_capacity);
+    // Heap capacities are always above INLINE_CAPACITY so is_inline() stays exact
+    new_capacity = std::max(new_capacity, INLINE_CAPACITY + 1);
+    int *p = allocate(new_capacity);
+    // Read through the const view: a shared buffer is copied, not unshared
+    std::memcpy(p, static_cast<const limb_vector &>(*this).data(), size_ * sizeof(int));
+    if (!is_inline() && !heap_.borrowed) release(heap_.limbs, capacity_);
+    heap_.limbs = p;
+    heap_.shared = false;
+    heap_.borrowed = false;
+    capacity_ = new_capacity;
+}
+
+void limb_vector::borrow(const int *limbs, size_type n) {
+    check_length(n);
+    reset();
+    if (n <= INLINE_CAPACITY) {
+        copy_from(limbs, n);
+        return;
+    }
+    // Never written through: the first write copies, as for a shared buffer
+    heap_.limbs = const_cast<int *>(limbs);
+    heap_.shared = true;
+    heap_.borrowed = true;
+    size_ = n;
+    capacity_ = n;
+}
+
+// Grow by half rather than doubling to keep slack on long values small,
+// stopping at max_size() unless more was asked for
+void limb_vector::grow(size_type min_capacity) {
+    size_type grown = std::min(max_size(), capacity_ + size_type(capacity_) / 2);
+    reallocate(std::max(min_capacity, grown));
+}
+
+void limb_vector::shrink_to_fit() {
+    if (is_inline() || size_ == capacity_ || heap_.borrowed) return;
+    if (size_ > INLINE_CAPACITY) {
+        reallocate(size_);
+        return;
+    }
+    int *p = heap_.limbs;
+    size_type old_capacity = capacity_;
+    std::memcpy(inline_, p, size_ * sizeof(int));
+    capacity_ = INLINE_CAPACITY;
+    release(p, old_capacity);
+}
+
+limb_vector::size_type limb_vector::heap_bytes() const {
+    if (is_inline() || heap_.borrowed) return 0;
+    return HEADER_BYTES + capacity_ * sizeof(int);
+}
+
+limb_vector::iterator limb_vector::insert(iterator pos, int value) {
+    size_type index = pos - begin();
+    if (size_ == capacity_) grow(size_type(size_) + 1);
+    int *p = data();
+    std::memmove(p + index + 1, p + index, (size_ - index) * sizeof(int));
+    p[index] = value;
+    ++size_;
+    return p + index;
+}
+
+void limb_vector::swap(limb_vector &other) noexcept {
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    // The union is trivially copyable; swapping its bytes swaps either mode
+    int buffer[INLINE_CAPACITY];
+    std::memcpy(buffer, inline_, sizeof(buffer));
+    std::memcpy(inline_, other.inline_, sizeof(buffer));
+    std::memcpy(other.inline_, buffer, sizeof(buffer));
+}
+
+} // namespace sjtu
@@ -0,0 +1,209 @@
+#include "include/register_machine.h"
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sjtu {
+
+static bool is_name(const std::string& token) {
+    if (token.empty() || !(std::isalpha((unsigned char)token[0]) || token[0] == '_')) return false;
+    for (char c : token) {
+        if (!(std::isalnum((unsigned char)c) || c == '_')) return false;
+    }
+    return token != "print" && token != "repeat" && token != "end";
+}
+
+static bool is_literal(const std::string& token) {
+    size_t i = (token[0] == '-' || token[0] == '+') ? 1 : 0;
+    if (i == token.size()) return false;
+    for (; i < token.size(); ++i) {
+        if (!std::isdigit((unsigned char)token[i])) return false;
+    }
+    return true;
+}
+
+static long long small_literal(const std::string& token, size_t line) {
+    if (!is_literal(token) || token.size() > 18) {
+        throw std::runtime_error("line " + std::to_string(line) + ": expected a small integer, got '" +
+                                 token + "'");
+    }
+    return std::stoll(token);
+}
+
+size_t register_machine::register_index(const std::string& name) {
+    std::map<std::string, size_t>::iterator it = names.find(name);
+    if (it != names.end()) return it->second;
+    names[name] = registers.size();
+    registers.emplace_back();
+    return registers.size() - 1;
+}
+
+int2048& register_machine::operator[](const std::string& name) {
+    return registers[register_index(name)];
+}
+
+const int2048* register_machine::find(const std::string& name) const {
+    std::map<std::string, size_t>::const_iterator it = names.find(name);
+    return it == names.end() ? nullptr : &registers[it->second];
+}
+
+void register_machine::clear() {
+    names.clear();
+    registers.clear();
+}
+
+void register_machine::run(const std::string& program, std::ostream& out) {
+    static const char* const OPERATORS[] = {"+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>"};
+    static const opcode OPCODES[] = {ADD, SUB, MUL, DIV, MOD, AND, OR, XOR, SHL, SHR};
+
+    std::vector<instruction> code;
+    std::vector<int2048> literals;
+    std::vector<size_t> open_loops;
+
+    std::istringstream lines(program);
+    std::string text;
+    for (size_t line = 1; std::getline(lines, text); ++line) {
+        text = text.substr(0, text.find('#'));
+        std::istringstream words(text);
+        std::vector<std::string> tokens;
+        for (std::string token; words >> token;) {
+            tokens.push_back(token);
+        }
+        if (tokens.empty()) continue;
+
+        std::string where = "line " + std::to_string(line) + ": ";
+        instruction ins = {ASSIGN, -1, -1, -1, 0, 0};
+
+        // Registers resolve to their index and literals to ~(pool index)
+        auto operand = [&](const std::string& token) -> long {
+            if (is_name(token)) return register_index(token);
+            if (!is_literal(token)) {
+                throw std::runtime_error(where + "bad operand '" + token + "'");
+            }
+            literals.emplace_back(token);
+            return ~(long)(literals.size() - 1);
+        };
+        auto binary_opcode = [&](const std::string& token) -> int {
+            for (int i = 0; i < 10; ++i) {
+                if (token == OPERATORS[i]) return i;
+            }
+            return -1;
+        };
+
+        if (tokens[0] == "print" && tokens.size() == 2 && is_name(tokens[1])) {
+            ins.op = PRINT;
+            ins.rhs = register_index(tokens[1]);
+        } else if (tokens[0] == "repeat" && tokens.size() == 2) {
+            ins.op = REPEAT;
+            ins.count = small_literal(tokens[1], line);
+            if (ins.count < 0) throw std::runtime_error(where + "negative repeat count");
+            open_loops.push_back(code.size());
+        } else if (tokens[0] == "end" && tokens.size() == 1) {
+            if (open_loops.empty()) throw std::runtime_error(where + "'end' without 'repeat'");
+            ins.op = END;
+            ins.jump = open_loops.back();
+            code[open_loops.back()].jump = code.size();
+            open_loops.pop_back();
+        } else if (tokens.size() == 3 && is_name(tokens[0]) && tokens[1] == "=") {
+            ins.dst = register_index(tokens[0]);
+            ins.rhs = operand(tokens[2]);
+        } else if (tokens.size() == 5 && is_name(tokens[0]) && tokens[1] == "=" &&
+                   binary_opcode(tokens[3]) >= 0) {
+            ins.op = OPCODES[binary_opcode(tokens[3])];
+            ins.dst = register_index(tokens[0]);
+            ins.lhs = operand(tokens[2]);
+            if (ins.op == SHL || ins.op == SHR) {
+                ins.rhs = ins.lhs;
+                ins.count = small_literal(tokens[4], line);
+            } else {
+                ins.rhs = operand(tokens[4]);
+            }
+        } else if (tokens.size() == 3 && is_name(tokens[0]) && tokens[1].size() >= 2 &&
+                   tokens[1].back() == '=' &&
+                   binary_opcode(tokens[1].substr(0, tokens[1].size() - 1)) >= 0) {
+            ins.op = OPCODES[binary_opcode(tokens[1].substr(0, tokens[1].size() - 1))];
+            ins.dst = ins.lhs = ins.rhs = register_index(tokens[0]);
+            if (ins.op == SHL || ins.op == SHR) {
+                ins.count = small_literal(tokens[2], line);
+            } else {
+                ins.rhs = operand(tokens[2]);
+            }
+        } else {
+            throw std::runtime_error(where + "cannot parse '" + text + "'");
+        }
+        code.push_back(ins);
+    }
+    if (!open_loops.empty()) {
+        throw std::runtime_error("'repeat' without 'end'");
+    }
+
+    execute(code, literals, out);
+}
+
+void register_machine::apply(opcode op, int2048& dst, const int2048& value, long long count) {
+    switch (op) {
+    case ADD: dst += value; break;
+    case SUB: dst -= value; break;
+    case MUL: dst *= value; break;
+    case DIV: dst /= value; break;
+    case MOD: dst %= value; break;
+    case AND: dst &= value; break;
+    case OR: dst |= value; break;
+    case XOR: dst ^= value; break;
+    case SHL: dst <<= count; break;
+    case SHR: dst >>= count; break;
+    default: break;
+    }
+}
+
+void register_machine::execute(const std::vector<instruction>& code,
+                               const std::vector<int2048>& literals, std::ostream& out) {
+    auto value = [&](long index) -> const int2048& {
+        return index >= 0 ? registers[index] : literals[~index];
+    };
+
+    std::vector<long long> remaining;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const instruction& ins = code[pc];
+        switch (ins.op) {
+        case PRINT:
+            out << registers[ins.rhs] << '\n';
+            break;
+        case REPEAT:
+            if (ins.count == 0) {
+                pc = ins.jump;
+            } else {
+                remaining.push_back(ins.count);
+            }
+            break;
+        case END:
+            if (--remaining.back() > 0) {
+                pc = ins.jump;
+            } else {
+                remaining.pop_back();
+            }
+            break;
+        case ASSIGN:
+            registers[ins.dst] = value(ins.rhs);
+            break;
+        default: {
+            int2048& dst = registers[ins.dst];
+            if (ins.lhs != ins.dst) {
+                if (ins.rhs == ins.dst) {
+                    // x = y op x: work in scratch so x is read intact
+                    scratch = value(ins.lhs);
+                    apply(ins.op, scratch, dst, ins.count);
+                    std::swap(dst, scratch);
+                    break;
+                }
+                dst = value(ins.lhs);
+            }
+            apply(ins.op, dst, value(ins.rhs), ins.count);
+            break;
+        }
+        }
+    }
+}
+
+} // namespace sjtu
@@ -0,0 +1,150 @@
+#include "include/thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+namespace sjtu {
+
+// The pool and deque of the worker running on this thread, if any
+static thread_local thread_pool* current_pool = nullptr;
+static thread_local size_t current_queue = 0;
+
+thread_pool::thread_pool(unsigned threads) : next_queue(0), pending(0), stopping(false) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) {
+        queues.emplace_back(new task_queue);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&thread_pool::work, this, i);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        stopping = true;
+    }
+    idle.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    size_t index = current_pool == this ? current_queue : next_queue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        ++pending;
+    }
+    idle.notify_one();
+}
+
+// Newest task of queue home, else the oldest of the first other queue
+// that has one
+bool thread_pool::take(size_t home, std::function<void()>& task) {
+    for (size_t i = 0; i < queues.size(); ++i) {
+        task_queue& queue = *queues[(home + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        std::lock_guard<std::mutex> idle_lock(idle_mutex);
+        --pending;
+        return true;
+    }
+    return false;
+}
+
+bool thread_pool::run_pending_task() {
+    std::function<void()> task;
+    size_t home = current_pool == this ? current_queue : next_queue++ % queues.size();
+    if (!take(home, task)) return false;
+    task();
+    return true;
+}
+
+void thread_pool::work(size_t index) {
+    current_pool = this;
+    current_queue = index;
+    for (;;) {
+        std::function<void()> task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        if (stopping && pending <= 0) return;
+        idle.wait(lock, [this] { return stopping || pending > 0; });
+    }
+}
+
+// The ranges of one parallel_for() call. Helper tasks and the caller
+// claim ranges by index, so the caller only ever runs its own ranges and
+// never waits behind unrelated tasks. Helpers that start after every
+// range is claimed do nothing; they share ownership of the group because
+// the caller may have returned by then.
+struct thread_pool::task_group {
+    const std::function<void(size_t, size_t)>* body;
+    size_t count;
+    size_t ranges;
+    std::atomic<size_t> next_range;
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t done;  // guarded by mutex
+    std::exception_ptr error;
+
+    // Runs claimed ranges until none are left
+    void run() {
+        for (size_t r; (r = next_range.fetch_add(1)) < ranges;) {
+            std::exception_ptr caught;
+            try {
+                (*body)(count * r / ranges, count * (r + 1) / ranges);
+            } catch (...) {
+                caught = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (caught && !error) error = caught;
+            if (++done == ranges) finished.notify_all();
+        }
+    }
+};
+
+void thread_pool::parallel_for(size_t count, size_t grain,
+                               const std::function<void(size_t, size_t)>& body) {
+    // A few ranges per thread, so that stealing can even out uneven ones
+    size_t ranges = std::min(count / std::max<size_t>(grain, 1), 4 * (size_t)(size() + 1));
+    if (ranges <= 1) {
+        if (count) body(0, count);
+        return;
+    }
+
+    std::shared_ptr<task_group> group = std::make_shared<task_group>();
+    group->body = &body;
+    group->count = count;
+    group->ranges = ranges;
+    group->next_range = 0;
+    group->done = 0;
+    for (size_t helper = 0; helper < std::min<size_t>(ranges - 1, size()); ++helper) {
+        submit([group] { group->run(); });
+    }
+    group->run();
+
+    std::unique_lock<std::mutex> lock(group->mutex);
+    group->finished.wait(lock, [&] { return group->done == ranges; });
+    if (group->error) std::rethrow_exception(group->error);
+}
+
+thread_pool& library_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+} // namespace sjtu
@@ -1,6 +1,25 @@
 #include "src/include/int2048.h"
+#include "src/include/int2048_async.h"
+#include "src/include/fixed_int.h"
+#include "src/include/int2048_expr.h"
+#include "src/include/int2048_hash.h"
+#include "src/include/int2048_stats.h"
+#include "src/include/limb_pool.h"
+#include "src/include/register_machine.h"
+#include "src/include/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
 #include <iostream>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 using namespace sjtu;
 
@@ -96,6 +115,13 @@ void test_floor_division() {
     std::cout << j << " / " << k << " = " << l << " (should be 3)" << std::endl;
     assert(l == int2048(3));
 
+    // Exact division must not be rounded down
+    assert(int2048(-10) / int2048(5) == int2048(-2));
+    assert(int2048(-10) % int2048(5) == int2048(0));
+
+    // Zero divided by -1 is zero, not a negative zero
+    assert(int2048(0) / int2048(-1) == int2048(0));
+
     std::cout << "Floor division tests passed!" << std::endl;
 }
 
@@ -118,12 +144,867 @@ void test_stream_operations() {
     std::cout << "Stream operations tests passed!" << std::endl;
 }
 
+void test_bitwise_operations() {
+    std::cout << "Testing bitwise operations..." << std::endl;
+
+    int2048 a("123456789012345678901234567890");
+    int2048 b("-98765432109876543210");
+
+    assert((a << 100) == int2048("156500072693749876333549759454926973536814597484617284976640"));
+    assert((a >> 37) == int2048("898266364037013255"));
+    assert((b >> 37) == int2048("-718613098"));
+    assert((b >> 1000) == int2048(-1));
+    assert((int2048(-7) >> 1) == int2048(-4));
+    assert((a << -37) == (a >> 37));
+    assert((a << LLONG_MIN) == int2048(0) && (b << LLONG_MIN) == int2048(-1));
+    assert((int2048(0) >> LLONG_MIN) == int2048(0));
+
+    assert((a & b) == int2048("123456788933793542183975452690"));
+    assert((a | b) == int2048("-20213295392617428010"));
+    assert((a ^ b) == int2048("-123456788954006837576592880700"));
+    assert(~a == -a - int2048(1));
+    assert((int2048(-1) & a) == a);
+
+    assert(a.bit_length() == 97);
+    assert(a.popcount() == 54);
+    assert(int2048(0).bit_length() == 0);
+    assert(int2048(-8).bit_length() == 4);
+
+    std::cout << "Bitwise operations tests passed!" << std::endl;
+}
+
+void test_decimal_shifts() {
+    std::cout << "Testing decimal shifts..." << std::endl;
+
+    int2048 a("-123456789012345678901");
+    int2048 b(a);
+    b.mul_pow10(13);
+    assert(b == int2048("-1234567890123456789010000000000000"));
+    b.div_pow10(13);
+    assert(b == a);
+
+    for (int k = 0; k < 30; ++k) {
+        int2048 power("1");
+        power.mul_pow10(k);
+        int2048 c(a);
+        assert(c.div_pow10(k) == a / power);
+        int2048 d(-a);
+        assert(d.shift10(-k) == -a / power);
+    }
+
+    int2048 e(-5);
+    assert(e.div_pow10(100) == int2048(-1));
+    assert(int2048(-5).mul_pow10(LLONG_MIN) == int2048(-1));
+    assert(int2048(5).shift10(LLONG_MIN) == int2048(0));
+    assert(int2048(0).div_pow10(LLONG_MIN) == int2048(0));
+
+    std::cout << "Decimal shift tests passed!" << std::endl;
+}
+
+void test_fused_multiply_add() {
+    std::cout << "Testing fused multiply-add..." << std::endl;
+
+    int2048 a("123456789012345678901234567890");
+    int2048 b("-987654321098765432109876543210");
+    int2048 c("1000000000000000000000000000000000000000000000000000000000000");
+
+    int2048 acc(c);
+    acc.addmul(a, b);
+    assert(acc == c + a * b);
+    acc.submul(a, b);
+    assert(acc == c);
+
+    // Crossing zero in both directions
+    int2048 small(5);
+    small.submul(a, a);
+    assert(small == int2048(5) - a * a);
+    small.addmul(a, a);
+    assert(small == int2048(5));
+
+    assert(fma(int2048(0), b, b) == b * b);
+    acc = a;
+    acc.addmul(acc, acc);
+    assert(acc == a + a * a);
+
+    std::cout << "Fused multiply-add tests passed!" << std::endl;
+}
+
+void test_expression_templates() {
+    std::cout << "Testing expression templates..." << std::endl;
+    using sjtu::expr::lazy;
+
+    int2048 a("123456789012345678901234567890");
+    int2048 b("-98765432109876543210");
+    int2048 c("555555555555555555555");
+    int2048 d(-7);
+
+    int2048 x;
+    sjtu::expr::assign(x, lazy(a) + b - lazy(c) * d);
+    assert(x == a + b - c * d);
+
+    // Destination used inside the expression
+    int2048 y(a);
+    sjtu::expr::assign(y, lazy(y) * y - y + (lazy(b) + c) * (lazy(c) - d));
+    assert(y == a * a - a + (b + c) * (c - d));
+
+    int2048 z = -(lazy(a) - b - c);
+    assert(z == b + c - a);
+
+    std::cout << "Expression template tests passed!" << std::endl;
+}
+
+void test_small_and_large_storage() {
+    std::cout << "Testing limb storage..." << std::endl;
+
+    // Values crossing the inline capacity in both directions
+    int2048 a("999999999999999999999999999999999999");
+    int2048 b(a);
+    b += int2048(1);
+    assert(b == int2048("1000000000000000000000000000000000000"));
+    b -= a;
+    assert(b == int2048(1));
+
+    int2048 c(std::move(a));
+    assert(c == int2048("999999999999999999999999999999999999"));
+    assert(a == int2048(0));
+    a = std::move(c);
+    assert(a == int2048("999999999999999999999999999999999999"));
+    assert(c == int2048(0));
+
+    // Capacity follows the value down and can be reserved up front
+    int2048 d(a * a * a * a);
+    d -= d - int2048(5);
+    assert(d == int2048(5));
+    assert(d.memory_usage() == sizeof(int2048));
+    d.reserve(1000);
+    assert(d.memory_usage() >= sizeof(int2048) + 1000 / 9 * sizeof(int));
+    d.shrink_to_fit();
+    assert(d.memory_usage() == sizeof(int2048));
+
+    // Lengths beyond the 32-bit size fields throw before allocating
+    limb_vector limbs(10, 1);
+    bool threw = false;
+    try {
+        limbs.resize(limb_vector::max_size() + 1);
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && limbs.size() == 10 && limbs[9] == 1);
+
+    std::cout << "Limb storage tests passed!" << std::endl;
+}
+
+void test_pool_allocator() {
+    std::cout << "Testing pooled limb allocation..." << std::endl;
+
+    sjtu::limb_allocator previous = sjtu::get_limb_allocator();
+    sjtu::set_limb_allocator(sjtu::limb_pool_allocator());
+    {
+        int2048 a("123456789012345678901234567890123456789012345678901234567890");
+        int2048 b = a * a;
+        assert(b / a == a);
+        assert(sjtu::limb_pool_cached_bytes() > 0);
+    }
+    sjtu::release_limb_pool();
+    assert(sjtu::limb_pool_cached_bytes() == 0);
+    sjtu::set_limb_allocator(previous);
+
+    // Buffers outliving a swap go back to the allocator that made them:
+    // pooled blocks are size-class sized, default ones are exact
+    int2048 made_default(std::string(20000, '7'));
+    int2048 conversion = made_default & made_default;
+    sjtu::set_limb_allocator(sjtu::limb_pool_allocator());
+    int2048 made_pooled(std::string(700, '3'));
+    clear_power_cache();
+    made_default = int2048(0);
+    for (int i = 0; i < 50; ++i) {
+        int2048 x(std::string(60 + i, '3'));
+        x *= x;
+        assert(x % int2048(std::string(60 + i, '3')) == int2048(0));
+    }
+    sjtu::set_limb_allocator(previous);
+    made_pooled *= made_pooled;
+    assert(conversion == int2048(std::string(20000, '7')));
+    conversion = made_pooled = int2048(0);
+    sjtu::release_limb_pool();
+
+    std::cout << "Pooled limb allocation tests passed!" << std::endl;
+}
+
+void test_copy_on_write() {
+    std::cout << "Testing copy-on-write sharing..." << std::endl;
+
+    // Copies point at the same buffer until one of them is written to
+    limb_vector x(5000, 7);
+    limb_vector y(x), z;
+    z = x;
+    const limb_vector &cx = x, &cy = y, &cz = z;
+    assert(cy.data() == cx.data() && cz.data() == cx.data() && x.is_shared());
+    y[0] = 8;
+    assert(cy.data() != cx.data() && cz.data() == cx.data() && !y.is_shared());
+    assert(cx[0] == 7 && cz[0] == 7 && cy[0] == 8);
+
+    std::string text(20000, '7');
+    int2048 a(text);
+    size_t live = get_memory_stats().live_bytes;
+    int2048 b(a);
+    int2048 c;
+    c = a;
+    // Counted only when tracking memory: the copies allocate nothing
+    assert(get_memory_stats().live_bytes == live);
+
+    // Writes through one copy never show up in the others
+    b += int2048(1);
+    assert(!memory_tracking_enabled() || get_memory_stats().live_bytes > live);
+    c.mul_pow10(1);
+    std::ostringstream oss;
+    oss << a;
+    assert(oss.str() == text);
+    assert(b - a == int2048(1));
+    assert(c == a * int2048(10));
+
+    std::cout << "Copy-on-write tests passed!" << std::endl;
+}
+
+void test_binary_serialization() {
+    std::cout << "Testing binary serialization..." << std::endl;
+
+    int2048 values[] = {int2048(0), int2048(-42), int2048(std::string(5000, '9')),
+                        -int2048(std::string(300, '1'))};
+    for (const int2048& value : values) {
+        std::vector<unsigned char> buffer(value.serialized_size());
+        assert(value.serialize(buffer.data(), buffer.size() - 1) == 0);
+        assert(value.serialize(buffer.data(), buffer.size()) == buffer.size());
+        assert(int2048::deserialize(buffer.data(), buffer.size()) == value);
+
+        int2048 view = int2048::view(buffer.data(), buffer.size());
+        assert(view == value);
+        view += int2048(1);
+        assert(int2048::view(buffer.data(), buffer.size()) == value);
+    }
+
+    unsigned char bad[16] = {'I', '2', 'K', 1};
+    bool thrown = false;
+    try {
+        int2048::deserialize(bad, sizeof(bad));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    // Shorter than the header
+    thrown = false;
+    try {
+        int2048::view(bad, 3);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Binary serialization tests passed!" << std::endl;
+}
+
+void test_decimal_files() {
+    std::cout << "Testing decimal file I/O..." << std::endl;
+
+    const std::string path = "test_file_io.tmp";
+    std::string text = "-" + std::string(700001, '8');
+    int2048 value(text);
+
+    value.to_file(path, 4);
+    assert(int2048::from_file(path) == value);
+    assert(int2048::from_file(path, 0) == value);
+
+    int2048(0).to_file(path);
+    assert(int2048::from_file(path, 3) == int2048(0));
+
+    std::ofstream(path) << "  +000123456789012345678901234567890\n";
+    assert(int2048::from_file(path) == int2048("123456789012345678901234567890"));
+
+    std::ofstream(path) << "12x4";
+    bool thrown = false;
+    try {
+        int2048::from_file(path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path.c_str());
+
+    std::cout << "Decimal file I/O tests passed!" << std::endl;
+}
+
+void test_register_machine() {
+    std::cout << "Testing register machine..." << std::endl;
+
+    register_machine machine;
+    std::ostringstream out;
+    machine.run("# 3^(2^10) mod m, by repeated squaring\n"
+                "m = 1000000007000000063\n"
+                "x = 3\n"
+                "repeat 10\n"
+                "  x = x * x\n"
+                "  x %= m\n"
+                "end\n"
+                "print x\n",
+                out);
+    int2048 m("1000000007000000063"), x(3);
+    for (int i = 0; i < 10; ++i) {
+        x = x * x % m;
+    }
+    std::ostringstream expected;
+    expected << x << '\n';
+    assert(out.str() == expected.str());
+
+    // Registers persist between runs, and x = y op x reads x before writing it
+    machine.run("y = 7\nx = y - x\nz = 5 << 3\nrepeat 0\nz = 0\nend\n", out);
+    assert(machine["x"] == int2048(7) - x);
+    assert(*machine.find("z") == int2048(40));
+    assert(machine.find("w") == nullptr);
+
+    bool thrown = false;
+    try {
+        machine.run("x = = 1\n", out);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Register machine tests passed!" << std::endl;
+}
+
+void test_algorithm_thresholds() {
+    std::cout << "Testing algorithm thresholds..." << std::endl;
+
+    const algorithm_thresholds defaults = get_algorithm_thresholds();
+    int2048 a(std::string(3000, '7')), b("-" + std::string(2000, '3'));
+    int2048 product = a * b;
+    int2048 shifted = a << 100000;
+
+    // Every crossover gives the same results on either side
+    algorithm_thresholds t = defaults;
+    t.karatsuba = 1;
+    t.decimal_shift_percent = 0;
+    set_algorithm_thresholds(t);
+    assert(get_algorithm_thresholds().karatsuba == 4);
+    assert(a * b == product);
+    assert((a << 100000) == shifted);
+
+    t.karatsuba = 1000000;
+    t.decimal_shift_percent = 1000000;
+    set_algorithm_thresholds(t);
+    assert(a * b == product);
+    assert((a << 100000) == shifted);
+    assert((shifted >> 100000) == a);
+
+    set_algorithm_thresholds(defaults);
+    std::cout << "Algorithm threshold tests passed!" << std::endl;
+}
+
+static void* failing_allocate(size_t) {
+    throw std::bad_alloc();
+}
+
+void test_operation_stats() {
+    std::cout << "Testing operation statistics..." << std::endl;
+
+    reset_stats();
+    int2048 a(std::string(2000, '4')), b(std::string(1000, '6'));
+    int2048 q = (a * b) / b;
+    assert(q == a);
+
+    std::vector<operation_stats> stats = get_stats();
+    assert(stats.size() == STAT_COUNT);
+    assert(std::string(stats[STAT_MULTIPLY_KARATSUBA].name) == "multiply.karatsuba");
+    std::ostringstream dump;
+    dump_stats(dump);
+    if (stats_enabled()) {
+        assert(stats[STAT_MULTIPLY].calls == 1);
+        assert(stats[STAT_MULTIPLY_KARATSUBA].calls > 0);
+        assert(stats[STAT_DIVIDE].calls == 1);
+        assert(stats[STAT_DIVIDE_LIMB_SEARCH].calls > 0);
+        assert(stats[STAT_ALLOCATE].calls > 0);
+        assert(dump.str().find("multiply.karatsuba") != std::string::npos);
+    } else {
+        for (const operation_stats& entry : stats) {
+            assert(entry.calls == 0);
+        }
+    }
+    if (memory_tracking_enabled()) {
+        // The product needs a heap buffer of its own, freed with it
+        assert(stats[STAT_MULTIPLY].peak_bytes >= 3000 / 9 * sizeof(int));
+        memory_stats held = get_memory_stats();
+        assert(held.live_bytes >= a.memory_usage() - sizeof(int2048));
+        assert(held.peak_bytes >= held.live_bytes);
+    }
+
+    // An allocation that throws is not counted as live
+    limb_allocator previous = get_limb_allocator();
+    size_t live = get_memory_stats().live_bytes;
+    set_limb_allocator({failing_allocate, previous.deallocate});
+    bool threw = false;
+    try {
+        int2048 big(std::string(1000, '1'));
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    set_limb_allocator(previous);
+    assert(threw && get_memory_stats().live_bytes == live);
+
+    reset_stats();
+    assert(get_stats()[STAT_MULTIPLY].calls == 0);
+
+    std::cout << "Operation statistics tests passed!" << std::endl;
+}
+
+void test_comparison() {
+    std::cout << "Testing comparison..." << std::endl;
+
+    // Leading zeros and negative zero read back normalized
+    int2048 padded("-0000000000000000000000123");
+    assert(padded == int2048(-123));
+    assert(int2048("-0000000000000") == int2048(0));
+    assert(compare(int2048("000000000000000000001"), int2048(1)) == 0);
+
+    std::string big(1000, '5');
+    int2048 x(big), y(big), z("-" + big);
+    y += int2048(1);
+    assert(compare(x, y) < 0 && compare(y, x) > 0 && compare(x, x) == 0);
+    assert(compare(z, x) < 0 && compare(z, int2048(-1)) < 0);
+    assert(x < y && y > x && x <= x && x >= x && x != y && x == int2048(big));
+
+    // A difference below the top limb, and copies sharing a buffer
+    int2048 low(big);
+    low += int2048(std::string(500, '1'));
+    int2048 copy(low);
+    assert(compare(x, low) < 0 && copy == low && compare(copy, low) == 0);
+
+    std::vector<int2048> values = {y, z, int2048(0), x, int2048(-1), low};
+    std::sort(values.begin(), values.end());
+    for (size_t i = 1; i < values.size(); ++i) {
+        assert(compare(values[i - 1], values[i]) < 0);
+    }
+#if __cplusplus >= 202002L
+    assert((x <=> y) == std::strong_ordering::less);
+    assert((x <=> int2048(big)) == std::strong_ordering::equal);
+#endif
+
+    std::cout << "Comparison tests passed!" << std::endl;
+}
+
+void test_hashing() {
+    std::cout << "Testing hashing..." << std::endl;
+
+    // Equal values hash equally however they were produced
+    int2048 a("123456789012345678901234567890123456789");
+    int2048 b = a * int2048(1000) / int2048(1000);
+    assert(std::hash<int2048>()(a) == std::hash<int2048>()(b));
+    assert(a.hash() != (-a).hash());
+    assert(int2048(0).hash() == (a - a).hash());
+
+    std::unordered_set<int2048> seen;
+    for (int i = 0; i < 1000; ++i) {
+        seen.insert(int2048(i % 250) << 200);
+        seen.insert(-(int2048(i % 250) * a));
+    }
+    assert(seen.size() == 250 + 249);
+    assert(seen.count(int2048(17) << 200) == 1);
+    assert(seen.count(int2048(250) << 200) == 0);
+
+    std::cout << "Hashing tests passed!" << std::endl;
+}
+
+void test_fixed_int() {
+    std::cout << "Testing fixed_int..." << std::endl;
+
+    typedef fixed_int<limbs_for_bits(2048)> fixed2048;
+    static_assert(fixed2048::LIMBS == 69, "2^2048 has 617 digits");
+    static_assert(limbs_for_bits(64) == 3, "2^64 has 20 digits");
+    static_assert((fixed_int<2>(999999999) + fixed_int<2>(1)).limb(1) == 1, "constexpr carry");
+    static_assert((fixed_int<2>(5) - fixed_int<2>(7)).is_negative(), "constexpr borrow");
+    static_assert(fixed_int<3>(-123456789012LL) * fixed_int<3>(-1000) ==
+                      fixed_int<3>(123456789012000LL), "constexpr product");
+
+    // Agrees with int2048 on mixed signs and carries through every limb
+    int2048 big = (int2048(1) << 2000) - int2048(1);
+    int2048 other("-987654321098765432109876543210987654321");
+    fixed2048 fb(big), fo(other);
+    assert(int2048(fb) == big && int2048(fo) == other);
+    assert(int2048(fb + fo) == big + other);
+    assert(int2048(fo - fb) == other - big);
+    assert(int2048(fo * fo) == other * other);
+    assert(int2048(fb - fb) == int2048(0) && !(fb - fb).is_negative());
+    assert(fo < fb && -fb < fo && compare(fb, fb) == 0);
+    std::ostringstream out;
+    out << fo << " " << fixed2048(0) << " " << fixed2048(-1000000000);
+    assert(out.str() == "-987654321098765432109876543210987654321 0 -1000000000");
+
+    // Results beyond the capacity throw instead of wrapping
+    bool threw = false;
+    try {
+        fixed2048 too_big(int2048(1) << 2100);
+    } catch (const std::overflow_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        fb *= fb;
+    } catch (const std::overflow_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        fixed_int<1> sum = fixed_int<1>(999999999);
+        sum += fixed_int<1>(1);
+    } catch (const std::overflow_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(int2048(fixed_int<2>(999999999) * fixed_int<2>(999999999)) ==
+           int2048(999999999LL * 999999999LL));
+
+    std::cout << "fixed_int tests passed!" << std::endl;
+}
+
+using namespace sjtu::literals;
+
+// Built at compile time; nothing runs at startup
+static constexpr auto MERSENNE_61 = 2305843009213693951_fixed;
+static constexpr fixed_int<7> PRODUCT =
+    fixed_int<7>(MERSENNE_61) * MERSENNE_61 * fixed_int<7>("-1'000'000'000'000'000'000");
+static_assert(MERSENNE_61.limb(0) == 213693951 && MERSENNE_61.limb(2) == 2,
+              "parsed at compile time");
+static_assert(fixed_int<2>("-0").is_zero() && !fixed_int<2>("-0").is_negative(),
+              "no negative zero");
+
+void test_constexpr_constants() {
+    std::cout << "Testing constexpr constants..." << std::endl;
+
+    int2048 m("2305843009213693951");
+    assert(int2048(MERSENNE_61) == m);
+    assert(int2048(PRODUCT) == m * m * int2048("-1000000000000000000"));
+
+    // view() borrows the constant's limbs instead of copying them
+    int2048 p = PRODUCT.view();
+    assert(p == int2048(PRODUCT) && p.memory_usage() == sizeof(int2048));
+    p += int2048(1);
+    assert(p == int2048(PRODUCT) + int2048(1) && int2048(PRODUCT) != p);
+
+    constexpr auto wide = 123456789012345678901234567890123456789012345678901234567890_fixed;
+    static_assert(decltype(wide)::LIMBS == 7, "sized by its digits");
+    std::ostringstream out;
+    out << wide << " " << -wide;
+    assert(out.str() == "123456789012345678901234567890123456789012345678901234567890 "
+                        "-123456789012345678901234567890123456789012345678901234567890");
+    assert(fixed_int<2>("+000000000000000042") == fixed_int<2>(42));
+
+    // Outside a constant expression bad text throws as usual
+    bool threw = false;
+    try {
+        std::string text = "12x4";
+        fixed_int<2> bad{std::string_view(text)};
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        fixed_int<1> narrow(wide);
+    } catch (const std::overflow_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "constexpr constant tests passed!" << std::endl;
+}
+
+void test_power_cache() {
+    std::cout << "Testing power cache..." << std::endl;
+
+    // Values on both sides of every split round trip through the binary form
+    clear_power_cache();
+    assert(power_cache_bytes() == 0);
+    std::string text = "9";
+    for (int i = 0; i < 12; ++i) {
+        text += text + std::to_string(i);
+        int2048 x(text), y("-" + text);
+        assert((x | int2048(0)) == x && (y ^ int2048(0)) == y);
+        assert(((x << 1000) >> 1000) == x && ((y >> 3) << 3) == y - (y & int2048(7)));
+        assert((x & y) + (x | y) == x + y);
+    }
+    size_t cached = power_cache_bytes();
+    assert(cached > 0);
+
+    // A limit below the cached bytes drops powers; results stay exact
+    int2048 big(text);
+    int2048 expected = (big << 12345) >> 12345;
+    set_power_cache_limit(cached / 2);
+    assert(power_cache_bytes() <= cached / 2);
+    assert(((big << 12345) >> 12345) == expected && expected == big);
+    set_power_cache_limit(0);
+    assert(power_cache_bytes() == 0);
+    assert(((big << 12345) >> 12345) == big && power_cache_bytes() == 0);
+
+    // Powers that are not kept are squared by each thread on its own
+    std::vector<std::thread> threads;
+    std::vector<int> correct(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            correct[t] = ((big << (1000 * t + 1)) >> (1000 * t + 1)) == big;
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    assert(std::count(correct.begin(), correct.end(), 1) == 4 && power_cache_bytes() == 0);
+    set_power_cache_limit(64u << 20);
+    assert(get_power_cache_limit() == 64u << 20);
+    clear_power_cache();
+
+    std::cout << "Power cache tests passed!" << std::endl;
+}
+
+// Build with -fsanitize=thread to check the contract in int2048.h: threads
+// share const operands (including their lazily built binary form) and copy
+// them while computing privately
+void test_concurrent_reads() {
+    std::cout << "Testing concurrent reads..." << std::endl;
+
+    std::string text;
+    for (int i = 0; i < 4000; ++i) text += char('1' + i * 7 % 9);
+    const int2048 a(text), b("-" + text.substr(0, 1500)), small(12345);
+    const int2048 product = a * b, quotient = a / b, conjunction = a & b, shifted = a << 3000;
+    const std::string printed = text;
+
+    const int THREADS = 4;
+    std::vector<int> failures(THREADS, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 20; ++i) {
+                int2048 copy(a);
+                copy += small;
+                std::ostringstream out;
+                out << a;
+                bool ok = a * b == product && a / b == quotient && (a & b) == conjunction &&
+                          (a << 3000) == shifted && a.bit_length() == shifted.bit_length() - 3000 &&
+                          a.hash() == int2048(a).hash() && out.str() == printed &&
+                          copy - small == a && compare(a, b) > 0;
+                if (!ok) ++failures[t];
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (int t = 0; t < THREADS; ++t) assert(failures[t] == 0);
+
+    std::cout << "Concurrent read tests passed!" << std::endl;
+}
+
+void test_batch_operations() {
+    std::cout << "Testing batch operations..." << std::endl;
+
+    // Enough limbs to be split into ranges on every worker
+    std::vector<int2048> a, b;
+    for (int i = 0; i < 600; ++i) {
+        std::string digits(50 + i * 37 % 900, char('1' + i % 9));
+        a.push_back(int2048(i % 3 ? digits : "-" + digits));
+        b.push_back(int2048(std::to_string(i * 7919 - 2000)) << (i % 50));
+    }
+
+    std::vector<int2048> products(a.size());
+    int2048::multiply_many(a.data(), b.data(), products.data(), a.size());
+    int2048 expected_sum(0);
+    std::vector<int2048> expected_prefix;
+    for (size_t i = 0; i < a.size(); ++i) {
+        assert(products[i] == a[i] * b[i]);
+        expected_sum += a[i];
+        expected_prefix.push_back(expected_sum);
+    }
+    assert(int2048::sum(a.data(), a.size()) == expected_sum);
+    assert(int2048::sum(a.data(), 0) == int2048(0) && int2048::sum(a.data(), 1) == a[0]);
+
+    std::vector<int2048> prefix(a.size());
+    int2048::prefix_sum(a.data(), prefix.data(), a.size());
+    assert(prefix == expected_prefix);
+
+    // In place
+    std::vector<int2048> c = a;
+    int2048::prefix_sum(c.data(), c.data(), c.size());
+    assert(c == expected_prefix);
+    c = b;
+    int2048::multiply_many(a.data(), c.data(), c.data(), c.size());
+    assert(c == products);
+
+    // Nested ranges and exceptions on the shared pool
+    std::vector<int> counts(64, 0);
+    library_pool().parallel_for(8, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            library_pool().parallel_for(8, 1, [&](size_t f, size_t l) {
+                for (size_t j = f; j < l; ++j) ++counts[i * 8 + j];
+            });
+        }
+    });
+    assert(std::count(counts.begin(), counts.end(), 1) == 64);
+    bool threw = false;
+    try {
+        int2048 zero(0);
+        std::vector<int2048> zeros(100, zero), quotients(100);
+        library_pool().parallel_for(100, 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) quotients[i] = a[i] / zeros[i];
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A caller waiting in parallel_for never runs tasks it did not submit,
+    // even one queued on its pool while its own ranges are in flight
+    std::thread::id foreign_thread;
+    {
+        thread_pool pool(1);
+        std::promise<void> started, release;
+        std::shared_future<void> released = release.get_future().share();
+        pool.submit([&started, released] {
+            started.set_value();
+            released.wait();
+        });
+        started.get_future().wait();
+        std::atomic<bool> submitted(false);
+        pool.parallel_for(8, 1, [&](size_t, size_t) {
+            if (!submitted.exchange(true)) {
+                pool.submit([&] { foreign_thread = std::this_thread::get_id(); });
+            }
+        });
+        release.set_value();
+    }
+    assert(foreign_thread != std::thread::id() && foreign_thread != std::this_thread::get_id());
+
+    std::cout << "Batch operation tests passed!" << std::endl;
+}
+
+void test_async_operations() {
+    std::cout << "Testing asynchronous operations..." << std::endl;
+
+    int2048 a(std::string(3000, '7')), b("-" + std::string(1200, '3'));
+    std::future<int2048> product = async_multiply(a, b);
+    std::future<int2048> quotient = async_divide(a, b);
+    std::future<int2048> power = async_pow(int2048(-3), 1001);
+    std::future<int2048> failed = async_divide(a, int2048(0));
+    assert(product.get() == a * b);
+    assert(quotient.get() == a / b);
+    int2048 expected(1);
+    for (int i = 0; i < 1001; ++i) expected *= int2048(-3);
+    assert(power.get() == expected);
+    assert(async_pow(int2048(0), 0).get() == int2048(1));
+    bool threw = false;
+    try {
+        failed.get();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // With every worker held on a latch and one more job queued, a batch
+    // call runs its own ranges and returns without taking the queued job
+    thread_pool& pool = library_pool();
+    std::mutex latch_mutex;
+    std::condition_variable latch;
+    unsigned holding = 0;
+    bool released = false;
+    for (unsigned i = 0; i < pool.size(); ++i) {
+        pool.submit([&] {
+            std::unique_lock<std::mutex> lock(latch_mutex);
+            ++holding;
+            latch.notify_all();
+            latch.wait(lock, [&] { return released; });
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(latch_mutex);
+        latch.wait(lock, [&] { return holding == pool.size(); });
+    }
+    std::promise<void> queued_ran;
+    pool.submit([&] { queued_ran.set_value(); });
+    std::future<void> queued = queued_ran.get_future();
+    std::vector<int2048> factors(64, int2048(std::string(900, '8'))), products(64);
+    int2048::multiply_many(factors.data(), factors.data(), products.data(), factors.size());
+    assert(products[63] == factors[63] * factors[63]);
+    assert(queued.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    {
+        std::lock_guard<std::mutex> lock(latch_mutex);
+        released = true;
+    }
+    latch.notify_all();
+    queued.wait();
+
+    // The kernels stop at their next check once the running operation is
+    // cancelled; cancelling up front makes the outcome independent of timing
+    {
+        cancel_token cancelled;
+        cancelled.cancel();
+        detail::cancel_scope scope(cancelled);
+        threw = false;
+        try {
+            a / b;
+        } catch (const operation_cancelled&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // Schoolbook products check too, so an unbalanced one that never
+        // reaches a Karatsuba split still stops
+        int2048 narrow(std::string(20, '9')), wide(std::string(900000, '9'));
+        threw = false;
+        try {
+            wide *= narrow;
+        } catch (const operation_cancelled&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // Operations started with a cancelled token stop before starting, while
+    // work on this thread is unaffected
+    cancel_token token;
+    token.cancel();
+    std::future<int2048> late = async_divide(a, b, token);
+    threw = false;
+    try {
+        late.get();
+    } catch (const operation_cancelled&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(a / b * b + a % b == a);
+
+    std::cout << "Asynchronous operation tests passed!" << std::endl;
+}
+
 int main() {
     try {
         test_basic_operations();
         test_operator_overloading();
         test_floor_division();
         test_stream_operations();
+        test_bitwise_operations();
+        test_decimal_shifts();
+        test_fused_multiply_add();
+        test_expression_templates();
+        test_small_and_large_storage();
+        test_pool_allocator();
+        test_copy_on_write();
+        test_binary_serialization();
+        test_decimal_files();
+        test_register_machine();
+        test_algorithm_thresholds();
+        test_operation_stats();
+        test_comparison();
+        test_hashing();
+        test_fixed_int();
+        test_constexpr_constants();
+        test_power_cache();
+        test_concurrent_reads();
+        test_batch_operations();
+        test_async_operations();
 
         std::cout << "All tests passed successfully!" << std::endl;
     } catch (const std::exception& e) {
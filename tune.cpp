@@ -0,0 +1,181 @@
+// Measures the algorithm crossovers of int2048 on this machine and prints
+// a src/include/int2048_thresholds.h holding them.
+//
+//   tune [--write path] [--quick]
+//
+// For every threshold a range of candidate values is timed on a workload
+// that straddles the crossover. A candidate scores the sum, over the
+// workload, of its time relative to the best candidate for that case, and
+// the lowest score wins. Scores go to standard error. --write replaces the
+// given header instead of printing it; --quick uses a smaller workload.
+#include "src/include/int2048.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sjtu;
+
+// Results are stored here so that no operation is optimized away
+volatile size_t tune_sink;
+
+static int2048 random_value(std::mt19937_64& rng, size_t limbs) {
+    std::string s(1, char('1' + rng() % 9));
+    for (size_t i = 1; i < limbs * 9; ++i) {
+        s += char('0' + rng() % 10);
+    }
+    return int2048(s);
+}
+
+// Seconds per call of f, the best of three batches of at least 2ms each
+template <class F> static double time_per_call(F f) {
+    size_t calls = 1;
+    double best = 0;
+    for (int round = 0; round < 3;) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            f();
+        }
+        double elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed < 2e-3) {
+            calls *= 2;
+            continue;
+        }
+        if (round == 0 || elapsed / calls < best) best = elapsed / calls;
+        ++round;
+    }
+    return best;
+}
+
+// Picks the candidate with the lowest relative score; times[c][w] is the
+// time of candidate c on workload case w
+static size_t pick(const char* name, const std::vector<size_t>& candidates,
+                   const std::vector<std::vector<double>>& times) {
+    size_t cases = times[0].size();
+    std::vector<double> score(candidates.size(), 0);
+    for (size_t w = 0; w < cases; ++w) {
+        double best = times[0][w];
+        for (size_t c = 1; c < candidates.size(); ++c) {
+            best = std::min(best, times[c][w]);
+        }
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            score[c] += times[c][w] / best;
+        }
+    }
+    size_t chosen = 0;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        std::fprintf(stderr, "%s %zu: %.3f\n", name, candidates[c], score[c] / cases);
+        if (score[c] < score[chosen]) chosen = c;
+    }
+    return candidates[chosen];
+}
+
+static size_t tune_karatsuba(std::mt19937_64& rng, bool quick) {
+    std::vector<size_t> candidates = {4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+    std::vector<size_t> sizes = {8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+    if (!quick) {
+        sizes.push_back(768);
+        sizes.push_back(1024);
+    }
+
+    algorithm_thresholds thresholds = get_algorithm_thresholds();
+    std::vector<std::vector<double>> times(candidates.size());
+    for (size_t n : sizes) {
+        int2048 a = random_value(rng, n), b = random_value(rng, n);
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            thresholds.karatsuba = candidates[c];
+            set_algorithm_thresholds(thresholds);
+            times[c].push_back(time_per_call([&] { tune_sink = (a * b).memory_usage(); }));
+        }
+    }
+    return pick("karatsuba", candidates, times);
+}
+
+static size_t tune_decimal_shift(std::mt19937_64& rng, bool quick) {
+    std::vector<size_t> candidates = {12, 25, 50, 100, 200, 400, 800, 1600};
+    std::vector<size_t> sizes = {16, 64, 256};
+    if (!quick) sizes.push_back(1024);
+
+    // Shifts of 1/16 to 32 passes per limb; >>= uses the same crossover
+    algorithm_thresholds thresholds = get_algorithm_thresholds();
+    std::vector<std::vector<double>> times(candidates.size());
+    for (size_t n : sizes) {
+        int2048 a = random_value(rng, n), r;
+        for (size_t passes = std::max<size_t>(1, n / 16); passes <= 32 * n; passes *= 2) {
+            long long k = 29LL * passes;
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                thresholds.decimal_shift_percent = candidates[c];
+                set_algorithm_thresholds(thresholds);
+                times[c].push_back(time_per_call([&] {
+                    r = a;
+                    r <<= k;
+                    tune_sink = r.memory_usage();
+                }));
+            }
+        }
+    }
+    return pick("decimal_shift_percent", candidates, times);
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--write" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--quick") {
+            quick = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--write path] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(2048);
+    const algorithm_thresholds defaults = get_algorithm_thresholds();
+    size_t karatsuba = tune_karatsuba(rng, quick);
+    set_algorithm_thresholds(defaults);
+    size_t shift_percent = tune_decimal_shift(rng, quick);
+    set_algorithm_thresholds(defaults);
+
+    std::ostringstream header;
+    header << "#pragma once\n"
+              "#ifndef SJTU_INT2048_THRESHOLDS\n"
+              "#define SJTU_INT2048_THRESHOLDS\n"
+              "\n"
+              "// Default algorithm crossovers for int2048 (see algorithm_thresholds in\n"
+              "// int2048.h). Generated by tune.cpp; rerun it on the target machine with\n"
+              "// --write to refresh, or override a value with -D at build time.\n"
+              "\n"
+              "#ifndef SJTU_KARATSUBA_THRESHOLD\n"
+              "#define SJTU_KARATSUBA_THRESHOLD "
+           << karatsuba
+           << "\n"
+              "#endif\n"
+              "\n"
+              "#ifndef SJTU_DECIMAL_SHIFT_PERCENT\n"
+              "#define SJTU_DECIMAL_SHIFT_PERCENT "
+           << shift_percent
+           << "\n"
+              "#endif\n"
+              "\n"
+              "#endif\n";
+
+    if (!path) {
+        std::cout << header.str();
+        return 0;
+    }
+    std::ofstream out(path, std::ios::binary);
+    out << header.str();
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    return 0;
+}